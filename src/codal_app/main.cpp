@@ -34,6 +34,7 @@ extern "C" void microbit_hal_timer_callback(void);
 extern "C" void microbit_hal_gesture_callback(int);
 extern "C" void microbit_hal_sound_synth_callback(int);
 extern "C" void microbit_radio_irq_handler(void);
+extern "C" void microbit_radio_timer_irq_handler(void);
 
 MicroBit uBit;
 
@@ -55,6 +56,7 @@ int main() {
     // Reconfigure the radio IRQ to our custom handler.
     // This must be done after uBit.init() in case BLE pairing mode is activated there.
     NVIC_SetVector(RADIO_IRQn, (uint32_t)microbit_radio_irq_handler);
+    NVIC_SetVector(TIMER4_IRQn, (uint32_t)microbit_radio_timer_irq_handler);
 
     // As well as configuring a larger RX buffer, this needs to be called so it
     // calls Serial::initialiseRx, to set up interrupts.
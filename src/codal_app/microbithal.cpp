@@ -92,6 +92,8 @@ static const PullMode pin_pull_mode_mapping[] = {
 static uint8_t pin_pull_state[32 + 6];
 static uint16_t touch_state[4];
 static uint16_t button_state[2];
+static uint64_t wake_on_pin_mask;
+static uint8_t wake_on_button_mask;
 
 extern "C" {
 
@@ -128,10 +130,43 @@ void microbit_hal_power_clear_wake_sources(void) {
 
 void microbit_hal_power_wake_on_button(int button, bool wake_on_active) {
     button_obj[button]->wakeOnActive(wake_on_active);
+    if (wake_on_active) {
+        wake_on_button_mask |= 1 << button;
+    } else {
+        wake_on_button_mask &= ~(1 << button);
+    }
 }
 
 void microbit_hal_power_wake_on_pin(int pin, bool wake_on_active) {
     pin_obj[pin]->wakeOnActive(wake_on_active);
+    if (wake_on_active) {
+        wake_on_pin_mask |= (uint64_t)1 << pin;
+    } else {
+        wake_on_pin_mask &= ~((uint64_t)1 << pin);
+    }
+}
+
+// Returns true if a configured wake source is active, ie it would end a deep sleep
+// straight away.  A pin is active when its level matches the level its SENSE
+// configuration, set up by wakeOnActive, is waiting for.
+bool microbit_hal_power_wake_source_active(void) {
+    for (size_t i = 0; i < HAL_ARRAY_SIZE(button_obj); ++i) {
+        if ((wake_on_button_mask & (1 << i)) && button_obj[i]->isPressed()) {
+            return true;
+        }
+    }
+    for (size_t i = 0; i < HAL_ARRAY_SIZE(pin_obj); ++i) {
+        if (wake_on_pin_mask & ((uint64_t)1 << i)) {
+            NRF_GPIO_Type *port = pin_obj[i]->name < 32 ? NRF_P0 : NRF_P1;
+            uint32_t n = pin_obj[i]->name & 31;
+            uint32_t sense = (port->PIN_CNF[n] & GPIO_PIN_CNF_SENSE_Msk) >> GPIO_PIN_CNF_SENSE_Pos;
+            uint32_t level = (port->IN >> n) & 1;
+            if (sense != GPIO_PIN_CNF_SENSE_Disabled && level == (sense == GPIO_PIN_CNF_SENSE_High)) {
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
 void microbit_hal_power_off(void) {
@@ -364,9 +399,10 @@ int microbit_hal_display_get_pixel(int x, int y) {
     }
 }
 
+// This mapping is designed to give a set of 10 visually distinct levels.
+static const uint8_t bright_map[10] = { 0, 1, 2, 4, 8, 16, 32, 64, 128, 255 };
+
 void microbit_hal_display_set_pixel(int x, int y, int bright) {
-    // This mapping is designed to give a set of 10 visually distinct levels.
-    static uint8_t bright_map[10] = { 0, 1, 2, 4, 8, 16, 32, 64, 128, 255 };
     if (bright < 0) {
         bright = 0;
     } else if (bright > 9) {
@@ -375,6 +411,20 @@ void microbit_hal_display_set_pixel(int x, int y, int bright) {
     uBit.display.image.setPixelValue(x, y, bright_map[bright]);
 }
 
+void microbit_hal_display_set_pixels(const uint8_t *bright) {
+    // The display image is 5x5 and stored row-major, so it can be written directly.
+    uint8_t *bitmap = uBit.display.image.getBitmap();
+    for (int i = 0; i < 25; ++i) {
+        uint8_t b = bright[i];
+        bitmap[i] = bright_map[b > 9 ? 9 : b];
+    }
+}
+
+void microbit_hal_display_set_levels(const uint8_t *levels) {
+    // Raw 0-255 values for all 25 pixels, bypassing bright_map.
+    memcpy(uBit.display.image.getBitmap(), levels, 25);
+}
+
 int microbit_hal_display_read_light_level(void) {
     return uBit.display.readLightLevel();
 }
@@ -431,10 +481,6 @@ int microbit_hal_compass_get_heading(void) {
     return uBit.compass.heading();
 }
 
-const uint8_t *microbit_hal_get_font_data(char c) {
-    return BitmapFont::getSystemFont().get(c);
-}
-
 static int microbit_hal_log_convert_return_value(int result) {
     if (result == DEVICE_OK) {
         return MICROBIT_HAL_DEVICE_OK;
@@ -120,6 +120,7 @@ int microbit_hal_temperature(void);
 void microbit_hal_power_clear_wake_sources(void);
 void microbit_hal_power_wake_on_button(int button, bool wake_on_active);
 void microbit_hal_power_wake_on_pin(int pin, bool wake_on_active);
+bool microbit_hal_power_wake_source_active(void);
 void microbit_hal_power_off(void);
 bool microbit_hal_power_deep_sleep(bool wake_on_ms, uint32_t ms);
 
@@ -150,6 +151,8 @@ int microbit_hal_button_state(int button, int *was_pressed, int *num_presses);
 void microbit_hal_display_enable(int value);
 int microbit_hal_display_get_pixel(int x, int y);
 void microbit_hal_display_set_pixel(int x, int y, int bright);
+void microbit_hal_display_set_pixels(const uint8_t *bright);
+void microbit_hal_display_set_levels(const uint8_t *levels);
 int microbit_hal_display_read_light_level(void);
 void microbit_hal_display_rotate(unsigned int rotation);
 
@@ -169,8 +172,6 @@ void microbit_hal_microphone_set_threshold(int kind, int value);
 int microbit_hal_microphone_get_level(void);
 float microbit_hal_microphone_get_level_db(void);
 
-const uint8_t *microbit_hal_get_font_data(char c);
-
 void microbit_hal_log_delete(bool full_erase);
 void microbit_hal_log_set_mirroring(bool serial);
 void microbit_hal_log_set_timestamp(int period);
@@ -32,6 +32,7 @@ public:
     bool started;
     DataSink *sink;
     ManagedBuffer buf;
+    ManagedBuffer spare;
     void (*callback)(void);
     MixerChannel *channel;
 
@@ -39,6 +40,22 @@ public:
         : started(false) {
     }
 
+    // Copy data into buf for the next pull.  A large AudioFrame is played as full
+    // chunks and then a shorter tail, so the buffer of the other length is kept in
+    // spare and the two are swapped rather than reallocated at each change.
+    void setData(const uint8_t *data, size_t len) {
+        if ((size_t)buf.length() != len) {
+            ManagedBuffer old = buf;
+            if ((size_t)spare.length() == len) {
+                buf = spare;
+            } else {
+                buf = ManagedBuffer(len);
+            }
+            spare = old;
+        }
+        memcpy(buf.getBytes(), data, len);
+    }
+
     virtual ManagedBuffer pull() {
         callback();
         return buf;
@@ -117,10 +134,7 @@ void microbit_hal_audio_init(uint32_t sample_rate) {
 }
 
 void microbit_hal_audio_write_data(const uint8_t *buf, size_t num_samples) {
-    if ((size_t)data_source.buf.length() != num_samples) {
-        data_source.buf = ManagedBuffer(num_samples);
-    }
-    memcpy(data_source.buf.getBytes(), buf, num_samples);
+    data_source.setData(buf, num_samples);
     data_source.sink->pullRequest();
 }
 
@@ -136,10 +150,7 @@ void microbit_hal_audio_speech_init(uint32_t sample_rate) {
 }
 
 void microbit_hal_audio_speech_write_data(const uint8_t *buf, size_t num_samples) {
-    if ((size_t)speech_source.buf.length() != num_samples) {
-        speech_source.buf = ManagedBuffer(num_samples);
-    }
-    memcpy(speech_source.buf.getBytes(), buf, num_samples);
+    speech_source.setData(buf, num_samples);
     speech_source.sink->pullRequest();
 }
 
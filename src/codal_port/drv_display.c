@@ -26,7 +26,6 @@
 
 #include <string.h>
 #include "py/runtime.h"
-#include "py/gc.h"
 #include "py/objstr.h"
 #include "py/mphal.h"
 #include "drv_display.h"
@@ -36,6 +35,12 @@
 #define ASYNC_MODE_STOPPED 0
 #define ASYNC_MODE_ANIMATION 1
 #define ASYNC_MODE_CLEAR 2
+#define ASYNC_MODE_PACKED 3
+
+// State of the prefetched animation frame in async_frame.
+#define FRAME_STATE_EMPTY 0 // the fetcher needs to prepare the next frame
+#define FRAME_STATE_READY 1 // the next frame is ready to be shown
+#define FRAME_STATE_END 2 // the iterator is exhausted, or failed
 
 static uint8_t async_mode;
 static mp_obj_t async_iterator = NULL;
@@ -44,8 +49,36 @@ static mp_uint_t async_delay = 1000;
 static mp_uint_t async_tick = 0;
 static bool async_clear = false;
 
+// Animation frames are fetched from the iterator by the scheduler, one frame ahead,
+// so the timer interrupt only has to copy a ready frame to the display.
+static uint8_t async_frame[MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT];
+static volatile uint8_t async_frame_state;
+static volatile bool async_fetcher_scheduled;
+static bool async_frame_late;
+static mp_uint_t async_late_frames;
+
+// Packed animations are replayed directly by the timer.
+static const microbit_animation_obj_t *async_animation;
+static uint16_t async_animation_frame;
+static bool async_loop;
+
+// High-depth mode: 0-255 levels per pixel, gamma-corrected and temporally dithered
+// by the timer on every tick, with optional linear fades between sets of levels.
+// Both only advance at the tick rate of MILLISECONDS_PER_MACRO_TICK: the fraction
+// of a level is spread over several ticks, so the lowest levels can visibly flicker,
+// and fades move in steps of one tick, with their length rounded down to a tick.
+static volatile bool hd_active;
+static uint8_t hd_start[MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT];
+static uint8_t hd_target[MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT];
+static uint8_t hd_error[MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT];
+static mp_uint_t hd_fade_ticks;
+static mp_uint_t hd_fade_tick;
+
+static void render_region(uint8_t *pixels, microbit_image_obj_t *image, mp_int_t x0, mp_int_t y0);
+
 static void async_stop(void) {
     async_iterator = NULL;
+    async_animation = NULL;
     async_mode = ASYNC_MODE_STOPPED;
     async_tick = 0;
     async_delay = 1000;
@@ -56,94 +89,259 @@ static void async_stop(void) {
 
 void microbit_display_init(void) {
     async_stop();
+    hd_active = false;
+    async_fetcher_scheduled = false;
+    async_frame_state = FRAME_STATE_EMPTY;
+    MP_STATE_PORT(display_viewport) = NULL;
 }
 
 void microbit_display_stop(void) {
+    // Cancel any animation, including a frame fetch that is already scheduled.
     MP_STATE_PORT(display_data) = NULL;
+    async_iterator = NULL;
+    async_frame_state = FRAME_STATE_EMPTY;
+    MP_STATE_PORT(display_viewport) = NULL;
+    hd_active = false;
+}
+
+mp_uint_t microbit_display_get_late_frames(void) {
+    return async_late_frames;
 }
 
 static void wait_for_event() {
-    while (!wakeup_event) {
-        // allow CTRL-C to stop the animation
-        if (MP_STATE_THREAD(mp_pending_exception) != MP_OBJ_NULL) {
-            async_stop();
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        // Run scheduled callbacks, including the frame fetcher, while waiting.
+        while (!wakeup_event) {
             mp_handle_pending(true);
-            return;
+            microbit_hal_idle();
         }
-        microbit_hal_idle();
+        nlr_pop();
+    } else {
+        // Allow CTRL-C (or any other exception) to stop the animation.
+        async_stop();
+        nlr_jump(nlr.ret_val);
     }
     wakeup_event = false;
 }
 
-static void draw_object(mp_obj_t obj) {
-    if (obj == MP_OBJ_STOP_ITERATION) {
+// Render an object from an animation iterator into a frame buffer.
+static bool render_object(uint8_t *pixels, mp_obj_t obj) {
+    if (mp_obj_get_type(obj) == &microbit_image_type) {
+        render_region(pixels, (microbit_image_obj_t *)obj, 0, 0);
+    } else if (MP_OBJ_IS_STR(obj)) {
+        mp_uint_t len;
+        const char *str = mp_obj_str_get_data(obj, &len);
+        if (len != 1) {
+            return false;
+        }
+        render_region(pixels, microbit_image_for_char(str[0]), 0, 0);
+    } else {
+        mp_sched_exception(mp_obj_new_exception_msg(&mp_type_TypeError, MP_ERROR_TEXT("not an image")));
+        return false;
+    }
+    return true;
+}
+
+static void async_frame_fetcher(void) {
+    async_fetcher_scheduled = false;
+    mp_obj_t iterator = async_iterator;
+    if (iterator == NULL || MP_STATE_PORT(display_data) == NULL || async_frame_state != FRAME_STATE_EMPTY) {
+        // the animation was cancelled after this fetch was scheduled
+        return;
+    }
+    bool ready;
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_obj_t obj = mp_iternext_allow_raise(iterator);
+        ready = obj != MP_OBJ_STOP_ITERATION && render_object(async_frame, obj);
+        nlr_pop();
+    } else {
+        if (!mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(((mp_obj_base_t*)nlr.ret_val)->type),
+            MP_OBJ_FROM_PTR(&mp_type_StopIteration))) {
+            mp_sched_exception(MP_OBJ_FROM_PTR(nlr.ret_val));
+        }
+        ready = false;
+    }
+    if (async_iterator != iterator) {
+        // the iterator itself replaced or stopped the animation
+        return;
+    }
+    __DMB(); // the frame must be complete before the timer can see it is ready
+    async_frame_state = ready ? FRAME_STATE_READY : FRAME_STATE_END;
+}
+
+static mp_obj_t async_frame_fetcher_wrapper(mp_obj_t arg) {
+    async_frame_fetcher();
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(async_frame_fetcher_wrapper_obj, async_frame_fetcher_wrapper);
+
+static void async_schedule_fetcher(void) {
+    if (async_frame_state == FRAME_STATE_EMPTY && !async_fetcher_scheduled) {
+        async_fetcher_scheduled = mp_sched_schedule(MP_OBJ_FROM_PTR(&async_frame_fetcher_wrapper_obj), mp_const_none);
+    }
+}
+
+// Show the prefetched frame.  Returns false if it is not ready yet.
+static bool async_show_frame(void) {
+    if (async_frame_state == FRAME_STATE_READY) {
+        microbit_hal_display_set_pixels(async_frame);
+        async_frame_state = FRAME_STATE_EMPTY;
+    } else if (async_frame_state == FRAME_STATE_END) {
+        // The state stays at FRAME_STATE_END, so the animation stops on the next frame.
         if (async_clear) {
             microbit_display_show(BLANK_IMAGE);
             async_clear = false;
         } else {
             async_stop();
         }
-    } else if (mp_obj_get_type(obj) == &microbit_image_type) {
-        microbit_display_show((microbit_image_obj_t *)obj);
-    } else if (MP_OBJ_IS_STR(obj)) {
-        mp_uint_t len;
-        const char *str = mp_obj_str_get_data(obj, &len);
-        if (len == 1) {
-            microbit_display_show(microbit_image_for_char(str[0]));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void async_show_packed_frame(void) {
+    const microbit_animation_obj_t *animation = async_animation;
+    if (async_animation_frame >= animation->num_frames) {
+        if (async_clear) {
+            // Stop on the next frame, after the display has been blank for one delay.
+            microbit_display_show(BLANK_IMAGE);
+            async_clear = false;
         } else {
             async_stop();
         }
-    } else {
-        mp_sched_exception(mp_obj_new_exception_msg(&mp_type_TypeError, MP_ERROR_TEXT("not an image")));
-        async_stop();
+        return;
+    }
+    uint8_t pixels[MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT];
+    const uint8_t *frame = animation->frames + async_animation_frame * MICROBIT_ANIMATION_FRAME_SIZE;
+    for (int i = 0; i < MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT; ++i) {
+        pixels[i] = (frame[i >> 1] >> ((i & 1) * 4)) & 15;
+    }
+    microbit_hal_display_set_pixels(pixels);
+    if (animation->delays != NULL) {
+        async_delay = animation->delays[async_animation_frame];
+    }
+    if (++async_animation_frame == animation->num_frames && async_loop) {
+        async_animation_frame = 0;
+    }
+}
+
+// Level of a high-depth pixel at the current point of its fade, in 8.8 fixed point.
+static uint32_t hd_level(int i) {
+    if (hd_fade_tick >= hd_fade_ticks) {
+        return hd_target[i] << 8;
+    }
+    // The product needs 64 bits, because a long fade has more than 2^23 / 255 ticks.
+    int32_t delta = (hd_target[i] - hd_start[i]) * 256;
+    return (hd_start[i] << 8) + (int32_t)((int64_t)delta * hd_fade_tick / (int64_t)hd_fade_ticks);
+}
+
+static void hd_update(void) {
+    uint8_t levels[MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT];
+    for (int i = 0; i < MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT; ++i) {
+        // Gamma 2 correction, keeping 8 fractional bits: out = level^2 / 255.
+        uint32_t level = hd_level(i);
+        uint32_t out = level * level / (255 << 8);
+        // Temporal dithering: carry the fractional part over to later ticks.
+        uint32_t error = hd_error[i] + (out & 0xff);
+        hd_error[i] = error;
+        levels[i] = MIN((out >> 8) + (error >> 8), 255);
+    }
+    microbit_hal_display_set_levels(levels);
+    if (hd_fade_tick < hd_fade_ticks) {
+        ++hd_fade_tick;
+    }
+}
+
+// Show 25 levels of 0-255, fading to them from the current high-depth levels (or
+// from blank) over fade_ms.  Any other display operation leaves this mode.
+void microbit_display_show_levels(const uint8_t *levels, mp_uint_t fade_ms) {
+    bool was_active = hd_active;
+    microbit_display_stop();
+    for (int i = 0; i < MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT; ++i) {
+        // microbit_display_stop() has paused the timer's use of these arrays.
+        hd_start[i] = was_active ? hd_level(i) >> 8 : 0;
+        hd_target[i] = levels[i];
+    }
+    hd_fade_ticks = fade_ms / MILLISECONDS_PER_MACRO_TICK;
+    hd_fade_tick = 0;
+    hd_active = true;
+}
+
+// While high-depth mode is active the display shows its levels rather than the
+// HAL's pixels, so set_pixel and get_pixel go through them, scaling brightness 0-9
+// to 0-255.  Setting a pixel ends its fade.  These return false if the mode is off.
+bool microbit_display_hd_set_pixel(mp_int_t x, mp_int_t y, mp_int_t bright) {
+    if (!hd_active) {
+        return false;
     }
+    int i = y * MICROBIT_DISPLAY_WIDTH + x;
+    uint8_t level = bright * 255 / MICROBIT_DISPLAY_MAX_BRIGHTNESS;
+    uint32_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    hd_start[i] = level;
+    hd_target[i] = level;
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
+    return true;
+}
+
+bool microbit_display_hd_get_pixel(mp_int_t x, mp_int_t y, mp_int_t *bright) {
+    if (!hd_active) {
+        return false;
+    }
+    int i = y * MICROBIT_DISPLAY_WIDTH + x;
+    *bright = (hd_target[i] * MICROBIT_DISPLAY_MAX_BRIGHTNESS + 127) / 255;
+    return true;
 }
 
 // TODO: pass in current timestamp as arg
 void microbit_display_update(void) {
-    async_tick += MILLISECONDS_PER_MACRO_TICK;
-    if (async_tick < async_delay) {
-        return;
+    if (hd_active) {
+        hd_update();
     }
-    async_tick = 0;
-    switch (async_mode) {
-        case ASYNC_MODE_ANIMATION:
-        {
-            if (MP_STATE_PORT(display_data) == NULL) {
-                async_stop();
-                break;
-            }
-            mp_obj_t obj;
-            nlr_buf_t nlr;
-            gc_lock();
-            if (nlr_push(&nlr) == 0) {
-                obj = mp_iternext_allow_raise(async_iterator);
-                nlr_pop();
-                gc_unlock();
-            } else {
-                gc_unlock();
-                if (!mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(((mp_obj_base_t*)nlr.ret_val)->type),
-                    MP_OBJ_FROM_PTR(&mp_type_StopIteration))) {
-                    if (mp_obj_get_type(nlr.ret_val) == &mp_type_MemoryError) {
-                        mp_printf(&mp_plat_print, "Allocation in interrupt handler");
+    async_tick += MILLISECONDS_PER_MACRO_TICK;
+    if (async_tick >= async_delay) {
+        async_tick = 0;
+        switch (async_mode) {
+            case ASYNC_MODE_ANIMATION:
+                if (MP_STATE_PORT(display_data) == NULL) {
+                    async_stop();
+                } else if (async_show_frame()) {
+                    async_frame_late = false;
+                } else {
+                    // The fetcher hasn't finished: show the frame on the first tick it's ready.
+                    if (!async_frame_late) {
+                        async_frame_late = true;
+                        ++async_late_frames;
                     }
-                    mp_sched_exception(MP_OBJ_FROM_PTR(nlr.ret_val));
+                    async_tick = async_delay - MILLISECONDS_PER_MACRO_TICK;
                 }
-                obj = MP_OBJ_STOP_ITERATION;
-            }
-            draw_object(obj);
-            break;
+                break;
+            case ASYNC_MODE_PACKED:
+                if (MP_STATE_PORT(display_data) == NULL) {
+                    async_stop();
+                } else {
+                    async_show_packed_frame();
+                }
+                break;
+            case ASYNC_MODE_CLEAR:
+                microbit_display_show(BLANK_IMAGE);
+                async_stop();
+                break;
         }
-        case ASYNC_MODE_CLEAR:
-            microbit_display_show(BLANK_IMAGE);
-            async_stop();
-            break;
+    }
+    if (async_mode == ASYNC_MODE_ANIMATION) {
+        // Called on every tick so a failed schedule (full queue) is retried.
+        async_schedule_fetcher();
     }
 }
 
 void microbit_display_clear(void) {
     // Reset repeat state, cancel animation and clear screen.
     // The actual screen clearing will be done by microbit_display_update.
+    MP_STATE_PORT(display_viewport) = NULL;
+    hd_active = false;
     wakeup_event = false;
     async_mode = ASYNC_MODE_CLEAR;
     async_tick = async_delay - MILLISECONDS_PER_MACRO_TICK;
@@ -151,24 +349,52 @@ void microbit_display_clear(void) {
 }
 
 void microbit_display_show(microbit_image_obj_t *image) {
-    mp_int_t w = MIN(image_width(image), 5);
-    mp_int_t h = MIN(image_height(image), 5);
-    mp_int_t x = 0;
-    for (; x < w; ++x) {
-        mp_int_t y = 0;
-        for (; y < h; ++y) {
-            uint8_t pix = image_get_pixel(image, x, y);
-            microbit_hal_display_set_pixel(x, y, pix);
+    microbit_display_show_region(image, 0, 0);
+}
+
+// Show the 5x5 region of the image with its top-left corner at (x0, y0).
+// Pixels outside the image are shown as blank.
+static void render_region(uint8_t *pixels, microbit_image_obj_t *image, mp_int_t x0, mp_int_t y0) {
+    if (image->base.five && x0 == 0 && y0 == 0) {
+        // Fast path: expand the packed bits of a 5x5 monochrome image directly.
+        const monochrome_5by5_t *mono = &image->monochrome_5by5;
+        uint32_t bits = mono->bits24[0] | mono->bits24[1] << 8 | mono->bits24[2] << 16 | mono->pixel44 << 24;
+        for (int i = 0; i < 25; ++i) {
+            pixels[i] = (bits & 1) * MICROBIT_DISPLAY_MAX_BRIGHTNESS;
+            bits >>= 1;
         }
-        for (; y < 5; ++y) {
-            microbit_hal_display_set_pixel(x, y, 0);
+    } else {
+        memset(pixels, 0, MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT);
+        mp_int_t x_start = MAX(0, -x0);
+        mp_int_t y_start = MAX(0, -y0);
+        mp_int_t x_end = MIN(image_width(image) - x0, 5);
+        mp_int_t y_end = MIN(image_height(image) - y0, 5);
+        for (mp_int_t y = y_start; y < y_end; ++y) {
+            for (mp_int_t x = x_start; x < x_end; ++x) {
+                pixels[y * 5 + x] = image_get_pixel(image, x0 + x, y0 + y);
+            }
         }
     }
-    for (; x < 5; ++x) {
-        for (mp_int_t y = 0; y < 5; ++y) {
-            microbit_hal_display_set_pixel(x, y, 0);
-        }
+}
+
+void microbit_display_show_region(microbit_image_obj_t *image, mp_int_t x0, mp_int_t y0) {
+    uint8_t pixels[MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT];
+    render_region(pixels, image, x0, y0);
+    microbit_hal_display_set_pixels(pixels);
+}
+
+void microbit_display_show_viewport(microbit_image_obj_t *image, mp_int_t x, mp_int_t y) {
+    MP_STATE_PORT(display_viewport) = image;
+    microbit_display_move_viewport(x, y);
+}
+
+bool microbit_display_move_viewport(mp_int_t x, mp_int_t y) {
+    microbit_image_obj_t *image = MP_STATE_PORT(display_viewport);
+    if (image == NULL) {
+        return false;
     }
+    microbit_display_show_region(image, x, y);
+    return true;
 }
 
 void microbit_display_scroll(const char *str) {
@@ -178,14 +404,38 @@ void microbit_display_scroll(const char *str) {
 
 void microbit_display_animate(mp_obj_t iterable, mp_int_t delay, bool clear, bool wait) {
     // Reset the repeat state.
+    async_mode = ASYNC_MODE_STOPPED;
     MP_STATE_PORT(display_data) = NULL;
+    MP_STATE_PORT(display_viewport) = NULL;
+    hd_active = false;
     async_iterator = mp_getiter(iterable, NULL);
     async_delay = delay;
     async_clear = clear;
+    async_frame_late = false;
+    async_late_frames = 0;
     MP_STATE_PORT(display_data) = async_iterator;
     wakeup_event = false;
-    mp_obj_t obj = mp_iternext_allow_raise(async_iterator);
-    draw_object(obj);
+
+    // Fetch and show the first frame now; the timer takes over from the next one.
+    // An exception from the iterator is raised here rather than deferred.  The
+    // scheduler must be locked because async_frame_fetcher() can also be called
+    // from the scheduler.
+    async_frame_state = FRAME_STATE_EMPTY;
+    mp_obj_t obj;
+    mp_sched_lock();
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        obj = mp_iternext(async_iterator);
+        nlr_pop();
+    } else {
+        mp_sched_unlock();
+        async_stop();
+        nlr_jump(nlr.ret_val);
+    }
+    bool ready = obj != MP_OBJ_STOP_ITERATION && render_object(async_frame, obj);
+    async_frame_state = ready ? FRAME_STATE_READY : FRAME_STATE_END;
+    mp_sched_unlock();
+    async_show_frame();
     async_tick = 0;
     async_mode = ASYNC_MODE_ANIMATION;
     if (wait) {
@@ -193,4 +443,26 @@ void microbit_display_animate(mp_obj_t iterable, mp_int_t delay, bool clear, boo
     }
 }
 
+void microbit_display_play(const microbit_animation_obj_t *animation, mp_int_t delay, bool clear, bool loop, bool wait) {
+    async_mode = ASYNC_MODE_STOPPED;
+    MP_STATE_PORT(display_viewport) = NULL;
+    hd_active = false;
+    async_iterator = NULL;
+    async_animation = animation;
+    async_animation_frame = 0;
+    async_delay = delay;
+    async_clear = clear;
+    async_loop = loop && animation->num_frames > 0;
+    // Keep a heap-allocated animation alive while it plays.
+    MP_STATE_PORT(display_data) = (void *)animation;
+    wakeup_event = false;
+    async_show_packed_frame();
+    async_tick = 0;
+    async_mode = ASYNC_MODE_PACKED;
+    if (wait) {
+        wait_for_event();
+    }
+}
+
 MP_REGISTER_ROOT_POINTER(void *display_data);
+MP_REGISTER_ROOT_POINTER(union _microbit_image_obj_t *display_viewport);
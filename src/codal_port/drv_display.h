@@ -35,13 +35,37 @@
 // Delay in ms in between moving display one column to the left.
 #define DEFAULT_SCROLL_SPEED_MS       150
 
+// Bytes per frame of a packed animation: 25 pixels, one nibble each, in the same
+// order as the pixel data of a 5x5 greyscale image.
+#define MICROBIT_ANIMATION_FRAME_SIZE (13)
+
+// A sequence of 5x5 frames that the display replays without calling back into
+// Python.  The delays and frames are referenced by pointer; Animation() allocates
+// them in the same heap block, straight after this struct.
+typedef struct _microbit_animation_obj_t {
+    mp_obj_base_t base;
+    uint16_t num_frames;
+    const uint16_t *delays; // per-frame delay in ms, or NULL to use the delay given to show()
+    const uint8_t *frames;
+} microbit_animation_obj_t;
+
+extern const mp_obj_type_t microbit_animation_type;
+
 void microbit_display_init(void);
 void microbit_display_stop(void);
 void microbit_display_update(void);
+mp_uint_t microbit_display_get_late_frames(void);
 
 void microbit_display_clear(void);
 void microbit_display_show(microbit_image_obj_t *image);
+void microbit_display_show_region(microbit_image_obj_t *image, mp_int_t x0, mp_int_t y0);
+void microbit_display_show_viewport(microbit_image_obj_t *image, mp_int_t x, mp_int_t y);
+void microbit_display_show_levels(const uint8_t *levels, mp_uint_t fade_ms);
+bool microbit_display_hd_set_pixel(mp_int_t x, mp_int_t y, mp_int_t bright);
+bool microbit_display_hd_get_pixel(mp_int_t x, mp_int_t y, mp_int_t *bright);
+bool microbit_display_move_viewport(mp_int_t x, mp_int_t y);
 void microbit_display_scroll(const char *str);
 void microbit_display_animate(mp_obj_t iterable, mp_int_t delay, bool clear, bool wait);
+void microbit_display_play(const microbit_animation_obj_t *animation, mp_int_t delay, bool clear, bool loop, bool wait);
 
 #endif // MICROPY_INCLUDED_CODAL_PORT_DRV_DISPLAY_H
@@ -26,6 +26,9 @@
  */
 
 #include <string.h>
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+#include <arm_acle.h>
+#endif
 #include "drv_image.h"
 #include "drv_display.h"
 
@@ -75,6 +78,79 @@ void greyscale_set_pixel(greyscale_t *self, mp_int_t x, mp_int_t y, mp_int_t val
     self->byte_data[index>>1] = (self->byte_data[index>>1] & mask) | (val << shift);
 }
 
+/* Kernels working directly on the packed pixel data, 8 pixels per 32-bit word.
+ * The low and high nibbles of each byte are split into two words with one pixel
+ * per byte lane, so intermediate results never carry between pixels.  Pixels are
+ * at most 9, but the unused nibble at the end of an image with an odd number of
+ * pixels may hold anything, so lanes must tolerate values up to 15. */
+
+#define LANES(x) ((uint32_t)(x) * 0x01010101)
+
+// Saturating per-lane a - b, for lanes no greater than 0x7f.
+static inline uint32_t lanes_sub_sat(uint32_t a, uint32_t b) {
+    #if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+    return __uqsub8(a, b);
+    #else
+    uint32_t d = (a | LANES(0x80)) - b;
+    uint32_t keep = ((d >> 7) & LANES(1)) * 0xff;
+    return d & keep & LANES(0x7f);
+    #endif
+}
+
+static inline uint32_t lanes_add(uint32_t a, uint32_t b) {
+    uint32_t sum = a + b;
+    return sum - lanes_sub_sat(sum, LANES(MICROBIT_DISPLAY_MAX_BRIGHTNESS));
+}
+
+static inline uint32_t lanes_sub(uint32_t a, uint32_t b) {
+    return lanes_sub_sat(a, b);
+}
+
+static inline uint32_t lanes_invert(uint32_t a, uint32_t b) {
+    (void)b;
+    // The 0x80 guard bit keeps a stray padding value from borrowing from the next lane.
+    return LANES(0x80 + MICROBIT_DISPLAY_MAX_BRIGHTNESS) - a;
+}
+
+static inline void greyscale_apply(greyscale_t *dest, const greyscale_t *lhs, const greyscale_t *rhs,
+    uint32_t (*op)(uint32_t, uint32_t)) {
+    size_t n = (dest->width * dest->height + 1) >> 1;
+    for (size_t i = 0; i < n; i += 4) {
+        size_t len = MIN(4, n - i);
+        uint32_t a = 0;
+        uint32_t b = 0;
+        memcpy(&a, lhs->byte_data + i, len);
+        memcpy(&b, rhs->byte_data + i, len);
+        uint32_t lo = op(a & LANES(0x0f), b & LANES(0x0f)) & LANES(0x0f);
+        uint32_t hi = op((a >> 4) & LANES(0x0f), (b >> 4) & LANES(0x0f)) & LANES(0x0f);
+        uint32_t result = lo | hi << 4;
+        memcpy(dest->byte_data + i, &result, len);
+    }
+}
+
+// The images must all be the same size; dest may be one of the sources.
+void greyscale_add(greyscale_t *dest, const greyscale_t *lhs, const greyscale_t *rhs) {
+    greyscale_apply(dest, lhs, rhs, lanes_add);
+}
+
+void greyscale_sub(greyscale_t *dest, const greyscale_t *lhs, const greyscale_t *rhs) {
+    greyscale_apply(dest, lhs, rhs, lanes_sub);
+}
+
+void greyscale_invert(greyscale_t *dest, const greyscale_t *src) {
+    greyscale_apply(dest, src, src, lanes_invert);
+}
+
+// Replace each pixel v of src with map[v], a byte (two pixels) at a time.
+// The map has 16 entries so that the padding nibble can be looked up too.
+void greyscale_map(greyscale_t *dest, const greyscale_t *src, const uint8_t *map) {
+    size_t n = (dest->width * dest->height + 1) >> 1;
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t b = src->byte_data[i];
+        dest->byte_data[i] = map[b & 15] | map[b >> 4] << 4;
+    }
+}
+
 mp_int_t image_width(microbit_image_obj_t *self) {
     if (self->base.five) {
         return 5;
@@ -112,15 +188,24 @@ greyscale_t *image_copy(microbit_image_obj_t *self) {
 }
 
 greyscale_t *image_invert(microbit_image_obj_t *self) {
+    greyscale_t *result = greyscale_new(image_width(self), image_height(self));
+    image_invert_into(self, result);
+    return result;
+}
+
+// The destination must be the same size as self, and may be self.
+void image_invert_into(microbit_image_obj_t *self, greyscale_t *dest) {
+    if (!self->base.five) {
+        greyscale_invert(dest, &self->greyscale);
+        return;
+    }
     mp_int_t w = image_width(self);
     mp_int_t h = image_height(self);
-    greyscale_t *result = greyscale_new(w, h);
     for (mp_int_t y = 0; y < h; y++) {
         for (mp_int_t x = 0; x < w; ++x) {
-            greyscale_set_pixel(result,x,y, MICROBIT_DISPLAY_MAX_BRIGHTNESS - image_get_pixel(self,x,y));
+            greyscale_set_pixel(dest,x,y, MICROBIT_DISPLAY_MAX_BRIGHTNESS - image_get_pixel(self,x,y));
         }
     }
-    return result;
 }
 
 static void clear_rect(greyscale_t *img, mp_int_t x0, mp_int_t y0,mp_int_t x1, mp_int_t y1) {
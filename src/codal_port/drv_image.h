@@ -85,12 +85,17 @@ void greyscale_clear(greyscale_t *self);
 void greyscale_fill(greyscale_t *self, mp_int_t val);
 uint8_t greyscale_get_pixel(greyscale_t *self, mp_int_t x, mp_int_t y);
 void greyscale_set_pixel(greyscale_t *self, mp_int_t x, mp_int_t y, mp_int_t val);
+void greyscale_add(greyscale_t *dest, const greyscale_t *lhs, const greyscale_t *rhs);
+void greyscale_sub(greyscale_t *dest, const greyscale_t *lhs, const greyscale_t *rhs);
+void greyscale_invert(greyscale_t *dest, const greyscale_t *src);
+void greyscale_map(greyscale_t *dest, const greyscale_t *src, const uint8_t *map);
 
 mp_int_t image_width(microbit_image_obj_t *self);
 mp_int_t image_height(microbit_image_obj_t *self);
 uint8_t image_get_pixel(microbit_image_obj_t *self, mp_int_t x, mp_int_t y);
 greyscale_t *image_copy(microbit_image_obj_t *self);
 greyscale_t *image_invert(microbit_image_obj_t *self);
+void image_invert_into(microbit_image_obj_t *self, greyscale_t *dest);
 void image_blit(microbit_image_obj_t *src, greyscale_t *dest, mp_int_t x, mp_int_t y, mp_int_t w, mp_int_t h, mp_int_t xdest, mp_int_t ydest);
 
 // Return a facade object that presents the string as a sequence of images
@@ -98,6 +103,8 @@ mp_obj_t microbit_string_facade(mp_obj_t string);
 
 microbit_image_obj_t *microbit_image_for_char(char c);
 microbit_image_obj_t *microbit_image_dim(microbit_image_obj_t *lhs, mp_float_t fval);
+void microbit_image_dim_into(microbit_image_obj_t *lhs, mp_float_t fval, greyscale_t *dest);
+void microbit_image_sum_into(microbit_image_obj_t *lhs, microbit_image_obj_t *rhs, bool add, greyscale_t *dest);
 
 // ref argument exists so that we can pull a string out of an object and not have it GC'ed while oterating over it
 mp_obj_t scrolling_string_image_iterable(const char* str, mp_uint_t len, mp_obj_t ref, bool monospace, bool repeat);
@@ -29,88 +29,1021 @@
 
 #include "py/runtime.h"
 #include "py/mphal.h"
+#include "py/stream.h"
+#include "drv_softtimer.h"
 #include "drv_radio.h"
+#include "drv_radio_queue.h"
 
-#define RADIO_PACKET_OVERHEAD (1 + 1 + 4) // 1 byte for len, 1 byte for RSSI, 4 bytes for time
+#define RADIO_PACKET_OVERHEAD (1 + 1 + 4 + 2 + 1) // 1 byte for len, 1 byte for RSSI, 4 bytes for time, 2 bytes for address, 1 byte for channel
 
-static uint8_t *rx_buf_end = NULL; // pointer to the end of the allocated RX queue
-static uint8_t *rx_buf = NULL; // pointer to last packet on the RX queue
+// Packets sent by radio.send() and by the reliable mode start with a 3-byte header
+// compatible with the micro:bit v1 DAL: version, group (unused) and protocol.  The
+// reliable mode protocols follow this with a sequence number, the source node and
+// the destination node.  The driver only interprets these protocols once a node id
+// has been configured.  Otherwise every packet is queued unchanged, so that
+// send_bytes() payloads which happen to start with the same bytes still reach
+// applications that don't use the protocols.
+#define RADIO_PROTOCOL_RELIABLE (3)
+#define RADIO_PROTOCOL_ACK (4)
+#define RADIO_RELIABLE_SEEN_LEN (8) // number of sources tracked for duplicate suppression
+
+// Large transfers send a buffer as a sequence of fragments, each with a header of
+// the 3-byte common header, a transfer id, the source and destination nodes, the
+// fragment index (16 bits), the total length (16 bits) and the fragment size.  The
+// sender sends a window of fragments and requests an ACK on the last one.  The ACK
+// has the same first 6 bytes, then the number of fragments received in order (16
+// bits) and a bitmap of which fragments in the window after those were received.
+#define RADIO_PROTOCOL_LARGE_DATA (5)
+#define RADIO_PROTOCOL_LARGE_DATA_ACK_REQ (6)
+#define RADIO_PROTOCOL_LARGE_ACK (7)
+#define RADIO_LARGE_ACK_LEN (9)
+#define RADIO_LARGE_WINDOW (8) // number of fragments in flight, at most 8 to fit the bitmap
+
+// Relayed packets have the 3-byte common header, a sequence number, the source node
+// and a TTL.  Each node that relays a packet decrements the TTL, and a recently-seen
+// cache keyed on the source and sequence number stops a packet being relayed or
+// delivered more than once.
+#define RADIO_PROTOCOL_RELAY (8)
+#define RADIO_RELAY_TIMER_CC (2) // compare channel of the timestamp timer used for the backoff
+
+// Burst packets are sent repeatedly for a whole listen interval so that a duty
+// cycled receiver catches one.  They have the 3-byte common header, a sequence
+// number, the source node and a reserved byte, and the recently-seen cache drops
+// the repeats.
+#define RADIO_PROTOCOL_BURST (9)
+
+#define RADIO_SEEN_LEN (32) // size of the recently-seen cache, must be a power of 2
+
+#define RADIO_HOP_TIMER_CC (3) // compare channel of the timestamp timer used for hopping
+#define RADIO_DUTY_TIMER_CC (4) // compare channel of the timestamp timer that closes a listen window
+
+#define RADIO_SHORTS_RX (RADIO_SHORTS_ADDRESS_RSSISTART_Msk)
+#define RADIO_SHORTS_TX (RADIO_SHORTS_READY_START_Msk | RADIO_SHORTS_END_DISABLE_Msk)
+#define RADIO_SHORTS_TX_BURST (RADIO_SHORTS_READY_START_Msk | RADIO_SHORTS_END_START_Msk)
+
+typedef enum {
+    RADIO_STATE_RX,
+    RADIO_STATE_TX,
+    RADIO_STATE_DISABLING, // disabling to retune or to sleep
+    RADIO_STATE_SLEEP, // disabled between listen windows
+} radio_state_t;
+
+static radio_queue_t rx_queue;
+static radio_queue_t tx_queue;
+static uint8_t *rx_dma_buf; // buffer that EasyDMA is currently receiving into
+static volatile radio_state_t radio_state;
+static uint32_t rx_timestamp_offset; // converts a timestamp timer count to mp_hal_ticks_us
+static microbit_radio_stats_t radio_stats;
+static volatile bool rx_callback_scheduled;
+static uint32_t radio_generation; // incremented each time the buffers are freed
+
+// Per logical address quota and count of packets in the RX queue.  The count is
+// split into a part only written by the IRQ and a part only written by pop, so it
+// can be kept without masking the IRQ.
+static uint8_t rx_quota[MICROBIT_RADIO_MAX_GROUPS];
+static uint16_t rx_addr_in[MICROBIT_RADIO_MAX_GROUPS];
+static volatile uint16_t rx_addr_out[MICROBIT_RADIO_MAX_GROUPS];
+
+// A packet generated by the IRQ itself (an ACK), sent ahead of the TX queue, and
+// a packet to relay, sent once its backoff expires.  tx_irq_pkt_on_air is whichever
+// of these is being transmitted, or NULL if it's a packet from the TX queue.
+static uint8_t *volatile tx_irq_pkt;
+static uint8_t *volatile tx_relay_pkt;
+static uint8_t *tx_irq_pkt_on_air;
+
+// State for the reliable mode.
+static bool radio_node_set; // whether the driver protocols are turned on
+static uint8_t radio_node; // this device's node id
+static uint8_t reliable_retries; // max number of retransmissions
+static uint8_t reliable_tx_seq; // sequence number of the last reliable packet sent
+static volatile uint8_t reliable_ack_dest; // node that the pending packet was sent to
+static volatile bool reliable_ack_waiting; // waiting for an ACK of reliable_tx_seq
+static volatile bool reliable_acked;
+static uint8_t ack_buf[1 + MAX(MICROBIT_RADIO_RELIABLE_HEADER_LEN, RADIO_LARGE_ACK_LEN)];
+static struct {
+    bool valid; // node ids span 0-255, so an unused entry can't be marked by its src
+    uint8_t src;
+    uint8_t seq;
+} reliable_seen[RADIO_RELIABLE_SEEN_LEN]; // last sequence number received from each source
+static uint8_t reliable_seen_next; // next entry to replace in reliable_seen
+
+// State for large transfers.  On the receiving side the IRQ writes fragments
+// straight into large_rx_buf, which is only set while the interpreter is waiting
+// in microbit_radio_receive_large_into().  The state of the last transfer is kept
+// after it completes, so that retransmitted fragments can still be ACKed.
+static uint8_t large_tx_id; // id of the last transfer sent
+static volatile uint8_t large_tx_dest; // node the current transfer is sent to
+static volatile bool large_tx_ack_waiting;
+static volatile bool large_tx_acked;
+static volatile uint16_t large_tx_ack_base;
+static volatile uint8_t large_tx_ack_bitmap;
+static uint8_t *volatile large_rx_buf;
+static size_t large_rx_buf_len;
+static volatile bool large_rx_done;
+static bool large_rx_active; // large_rx_id and large_rx_src identify a transfer
+static uint8_t large_rx_id;
+static uint8_t large_rx_src;
+static uint8_t large_rx_frag_size;
+static uint16_t large_rx_len; // total length of the transfer
+static uint16_t large_rx_num_frags;
+static uint16_t large_rx_base; // number of fragments received in order
+static uint8_t large_rx_bitmap; // fragments received after large_rx_base
+
+// State for relaying.  The relay buffer is owned by the IRQ from when a packet is
+// copied into it until that packet has been transmitted.
+static bool relay_enabled;
+static uint8_t relay_tx_seq; // sequence number of the last relayed packet sent
+static uint8_t *relay_buf;
+static bool relay_busy;
+static uint32_t relay_rng_state; // for the backoff, seeded when the radio is enabled
+static uint32_t rx_seen[RADIO_SEEN_LEN]; // 1 + (protocol << 16 | src << 8 | seq), 0 if unused
+
+// State for channel hopping.  The timer IRQ advances the schedule and sets
+// hop_pending, and the new channel is tuned the next time the radio is disabled.
+static uint8_t hop_channels[MICROBIT_RADIO_MAX_HOPS];
+static uint8_t hop_num_channels; // 0 if not hopping
+static uint8_t hop_index;
+static uint32_t hop_dwell_us;
+static bool hop_pending;
+
+// State for duty-cycled listening.  A soft timer opens each listen window and a
+// compare on the timestamp timer closes it, and the radio IRQ disables the receiver
+// while duty_asleep is set.  Between windows the HFXO and the timestamp timer are
+// stopped too, see radio_sleep().
+static microbit_soft_timer_entry_t duty_timer;
+static uint16_t duty_interval_ms; // 0 if listening continuously
+static uint16_t duty_window_ms;
+static volatile bool duty_asleep;
+static volatile bool duty_opening; // set by the soft timer, cleared by the radio IRQ
+static bool duty_powered_down; // HFXO and timestamp timer stopped while asleep
+static uint32_t duty_last_time; // mp_hal_ticks_us() at the last state change
+static bool radio_hfxo_started; // whether the radio started the HFXO, so may stop it
+static uint8_t burst_tx_seq; // sequence number of the last burst sent
+
+// State for capture mode, a ring of variable length records written by the IRQ and
+// drained by the interpreter.  Like the packet queues the indices wrap at twice the
+// size, so a full ring can be told from an empty one whatever the size.
+static size_t capture_size;
+static volatile uint32_t capture_head; // next byte to be written, 0 <= head < 2 * size
+static volatile uint32_t capture_tail; // next byte to be read, 0 <= tail < 2 * size
+
+// Point EasyDMA at the next free RX queue slot so the packet is received in place,
+// without a copy.  If the queue is full then receive into the tx/rx buffer instead,
+// and the packet will be dropped when it arrives.
+static void radio_rx_prepare(void) {
+    if (!radio_queue_is_full(&rx_queue)) {
+        rx_dma_buf = radio_queue_slot(&rx_queue, rx_queue.head);
+    } else {
+        rx_dma_buf = MP_STATE_PORT(radio_buf);
+    }
+    NRF_RADIO->PACKETPTR = (uint32_t)rx_dma_buf;
+}
+
+static void radio_rx_start(void) {
+    radio_rx_prepare();
+    NRF_RADIO->EVENTS_ADDRESS = 0;
+    NRF_RADIO->TASKS_START = 1;
+}
+
+static mp_obj_t radio_rx_callback_wrapper(mp_obj_t arg) {
+    (void)arg;
+    // Clear the flag before calling so packets arriving during the callback schedule it again.
+    rx_callback_scheduled = false;
+    mp_obj_t callback = MP_STATE_PORT(radio_rx_callback);
+    if (callback != MP_OBJ_NULL) {
+        mp_call_function_0(callback);
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(radio_rx_callback_wrapper_obj, radio_rx_callback_wrapper);
+
+static void radio_rx_large_data(const uint8_t *pkt, size_t len) {
+    if (len < MICROBIT_RADIO_LARGE_HEADER_LEN) {
+        return;
+    }
+    uint8_t id = pkt[4];
+    uint8_t src = pkt[5];
+    uint16_t idx = pkt[7] | pkt[8] << 8;
+    uint16_t total = pkt[9] | pkt[10] << 8;
+    uint8_t frag_size = pkt[11];
+
+    if (!large_rx_active || id != large_rx_id || src != large_rx_src) {
+        // a new transfer, which is only accepted if there is a buffer big enough to
+        // receive it; otherwise it isn't ACKed, so the sender gives up
+        if (large_rx_buf == NULL || frag_size == 0 || total > large_rx_buf_len) {
+            return;
+        }
+        large_rx_active = true;
+        large_rx_id = id;
+        large_rx_src = src;
+        large_rx_frag_size = frag_size;
+        large_rx_len = total;
+        large_rx_num_frags = total == 0 ? 1 : (total + frag_size - 1) / frag_size;
+        large_rx_base = 0;
+        large_rx_bitmap = 0;
+    }
+
+    // store the fragment if it's in the window and not already received
+    uint8_t *buf = large_rx_buf;
+    if (buf != NULL && idx >= large_rx_base && idx < large_rx_base + RADIO_LARGE_WINDOW && idx < large_rx_num_frags) {
+        uint8_t bit = 1 << (idx - large_rx_base);
+        if (!(large_rx_bitmap & bit)) {
+            size_t offset = idx * large_rx_frag_size;
+            if (offset < large_rx_buf_len) {
+                memcpy(buf + offset, pkt + 1 + MICROBIT_RADIO_LARGE_HEADER_LEN,
+                    MIN(len - MICROBIT_RADIO_LARGE_HEADER_LEN, large_rx_buf_len - offset));
+            }
+            large_rx_bitmap |= bit;
+            while (large_rx_bitmap & 1) {
+                large_rx_bitmap >>= 1;
+                ++large_rx_base;
+            }
+            if (large_rx_base == large_rx_num_frags) {
+                large_rx_done = true;
+            }
+        }
+    }
+
+    if (pkt[3] == RADIO_PROTOCOL_LARGE_DATA_ACK_REQ) {
+        ack_buf[0] = RADIO_LARGE_ACK_LEN;
+        ack_buf[1] = 1;
+        ack_buf[2] = 0;
+        ack_buf[3] = RADIO_PROTOCOL_LARGE_ACK;
+        ack_buf[4] = id;
+        ack_buf[5] = radio_node;
+        ack_buf[6] = src;
+        ack_buf[7] = large_rx_base & 0xff;
+        ack_buf[8] = large_rx_base >> 8;
+        ack_buf[9] = large_rx_bitmap;
+        tx_irq_pkt = ack_buf;
+    }
+}
+
+// Time in microseconds to send a packet with the given payload length.
+static uint32_t radio_air_time_us(size_t len) {
+    uint32_t mode = NRF_RADIO->MODE;
+    // preamble, address, length, payload and CRC
+    uint32_t bits = 8 * ((mode == RADIO_MODE_MODE_Nrf_2Mbit ? 2 : 1) + 5 + 1 + len + 2);
+    if (mode == RADIO_MODE_MODE_Nrf_2Mbit) {
+        return bits / 2;
+    } else if (mode == RADIO_MODE_MODE_Nrf_250Kbit) {
+        return bits * 4;
+    } else {
+        return bits;
+    }
+}
+
+// The recently-seen cache is direct mapped, so a collision evicts the older entry,
+// in which case a relayed packet may be relayed again (but its TTL still bounds
+// how far it goes) or a burst repeat delivered.
+static uint32_t *radio_seen_entry(uint32_t key) {
+    return &rx_seen[(key * 2654435769u) >> 27 & (RADIO_SEEN_LEN - 1)];
+}
+
+// Returns true if the packet with the given protocol, source and sequence number
+// was seen recently.
+static bool radio_is_seen(uint8_t protocol, uint8_t src, uint8_t seq) {
+    uint32_t key = 1 + (protocol << 16 | src << 8 | seq);
+    return *radio_seen_entry(key) == key;
+}
+
+static void radio_set_seen(uint8_t protocol, uint8_t src, uint8_t seq) {
+    uint32_t key = 1 + (protocol << 16 | src << 8 | seq);
+    *radio_seen_entry(key) = key;
+}
+
+// Like radio_is_seen(), but also records the packet as seen.
+static bool radio_check_seen(uint8_t protocol, uint8_t src, uint8_t seq) {
+    if (radio_is_seen(protocol, src, seq)) {
+        return true;
+    }
+    radio_set_seen(protocol, src, seq);
+    return false;
+}
+
+// Copy a packet to the relay buffer with its TTL decremented, and start a random
+// backoff so that neighbouring relays don't all transmit at once.
+static void radio_relay_schedule(const uint8_t *pkt, size_t len) {
+    if (pkt[6] <= 1) {
+        ++radio_stats.relay_expired;
+        return;
+    }
+    if (relay_busy) {
+        ++radio_stats.relay_dropped;
+        return;
+    }
+    relay_busy = true;
+    memcpy(relay_buf, pkt, 1 + len);
+    --relay_buf[6];
+
+    // xorshift32, cheap enough for the IRQ
+    relay_rng_state ^= relay_rng_state << 13;
+    relay_rng_state ^= relay_rng_state >> 17;
+    relay_rng_state ^= relay_rng_state << 5;
+    uint32_t backoff_us = 150 + relay_rng_state % (4 * radio_air_time_us(len));
+
+    NRF_TIMER_Type *timer = MICROBIT_RADIO_TIMESTAMP_TIMER;
+    timer->TASKS_CAPTURE[RADIO_RELAY_TIMER_CC] = 1;
+    timer->CC[RADIO_RELAY_TIMER_CC] += backoff_us;
+    timer->EVENTS_COMPARE[RADIO_RELAY_TIMER_CC] = 0;
+    timer->INTENSET = TIMER_INTENSET_COMPARE0_Msk << RADIO_RELAY_TIMER_CC;
+}
+
+// Advance a capture index by n bytes, at most the size of the ring.
+static inline uint32_t radio_capture_advance(uint32_t idx, size_t n) {
+    idx += n;
+    return idx >= 2 * capture_size ? idx - 2 * capture_size : idx;
+}
+
+static inline size_t radio_capture_used(uint32_t head, uint32_t tail) {
+    return head >= tail ? head - tail : head + 2 * capture_size - tail;
+}
+
+static inline size_t radio_capture_offset(uint32_t idx) {
+    return idx >= capture_size ? idx - capture_size : idx;
+}
+
+// Copy from/to the capture ring, wrapping around its end.
+static void radio_capture_write(uint32_t idx, const void *src, size_t len) {
+    uint8_t *buf = MP_STATE_PORT(radio_capture_buf);
+    size_t offset = radio_capture_offset(idx);
+    size_t n = MIN(len, capture_size - offset);
+    memcpy(buf + offset, src, n);
+    memcpy(buf, (const uint8_t *)src + n, len - n);
+}
+
+// Record a packet exactly as received, including ones with a bad CRC.
+static void radio_capture_packet(const uint8_t *pkt, size_t len) {
+    uint32_t head = capture_head;
+    if (MICROBIT_RADIO_CAPTURE_HEADER_LEN + len > capture_size - radio_capture_used(head, capture_tail)) {
+        ++radio_stats.capture_dropped;
+        return;
+    }
+
+    uint32_t time = MICROBIT_RADIO_TIMESTAMP_TIMER->CC[0] + rx_timestamp_offset;
+    uint8_t header[MICROBIT_RADIO_CAPTURE_HEADER_LEN] = {
+        len,
+        NRF_RADIO->CRCSTATUS == 1 ? MICROBIT_RADIO_CAPTURE_FLAG_CRC_OK : 0,
+        NRF_RADIO->RSSISAMPLE,
+        NRF_RADIO->FREQUENCY,
+        time & 0xff, (time >> 8) & 0xff, (time >> 16) & 0xff, (time >> 24) & 0xff,
+    };
+    radio_capture_write(head, header, MICROBIT_RADIO_CAPTURE_HEADER_LEN);
+    radio_capture_write(radio_capture_advance(head, MICROBIT_RADIO_CAPTURE_HEADER_LEN), pkt + 1, len);
+
+    // publish the record to the interpreter
+    __DMB();
+    capture_head = radio_capture_advance(head, MICROBIT_RADIO_CAPTURE_HEADER_LEN + len);
+    ++radio_stats.capture_packets;
+}
+
+static void radio_rx_packet(void) {
+    size_t max_len = NRF_RADIO->PCNF1 & 0xff;
+    uint8_t *pkt = rx_dma_buf;
+    size_t len = pkt[0];
+    if (len > max_len) {
+        len = max_len;
+        pkt[0] = len;
+        ++radio_stats.rx_truncated;
+    }
+
+    if (MP_STATE_PORT(radio_capture_buf) != NULL) {
+        // capture mode is passive, packets are only recorded
+        radio_capture_packet(pkt, len);
+        return;
+    }
+
+    if (NRF_RADIO->CRCSTATUS != 1) {
+        ++radio_stats.rx_crc_errors;
+        return;
+    }
+
+    // check for the reliable mode and relay protocols
+    bool reliable = false;
+    bool burst = false;
+    size_t header_len = 0;
+    if (radio_node_set && len >= MICROBIT_RADIO_RELIABLE_HEADER_LEN && pkt[1] == 1 && pkt[2] == 0) {
+        uint8_t seq = pkt[4];
+        uint8_t src = pkt[5];
+        uint8_t dest = pkt[6];
+        if (pkt[3] == RADIO_PROTOCOL_ACK) {
+            // an ACK, which is never queued
+            if (dest == radio_node && reliable_ack_waiting && seq == reliable_tx_seq && src == reliable_ack_dest) {
+                reliable_ack_waiting = false;
+                reliable_acked = true;
+            }
+            return;
+        } else if (pkt[3] == RADIO_PROTOCOL_RELIABLE) {
+            if (dest != radio_node) {
+                // unicast to another node
+                return;
+            }
+            reliable = true;
+            header_len = MICROBIT_RADIO_RELIABLE_HEADER_LEN;
+        } else if (pkt[3] == RADIO_PROTOCOL_RELAY) {
+            // here dest is the TTL
+            if (src == radio_node || radio_check_seen(RADIO_PROTOCOL_RELAY, src, seq)) {
+                ++radio_stats.relay_duplicates;
+                return;
+            }
+            if (relay_enabled) {
+                radio_relay_schedule(pkt, len);
+            }
+            header_len = MICROBIT_RADIO_RELAY_HEADER_LEN;
+        } else if (pkt[3] == RADIO_PROTOCOL_BURST) {
+            // the burst is only recorded as seen once it is queued, so if this copy
+            // is dropped a later repeat can still get through
+            if (radio_is_seen(RADIO_PROTOCOL_BURST, src, seq)) {
+                ++radio_stats.rx_duplicates;
+                return;
+            }
+            burst = true;
+            header_len = MICROBIT_RADIO_BURST_HEADER_LEN;
+        } else if (pkt[3] == RADIO_PROTOCOL_LARGE_ACK) {
+            if (len >= RADIO_LARGE_ACK_LEN && dest == radio_node && large_tx_ack_waiting
+                && seq == large_tx_id && src == large_tx_dest) {
+                large_tx_ack_base = pkt[7] | pkt[8] << 8;
+                large_tx_ack_bitmap = pkt[9];
+                large_tx_ack_waiting = false;
+                large_tx_acked = true;
+            }
+            return;
+        } else if (pkt[3] == RADIO_PROTOCOL_LARGE_DATA || pkt[3] == RADIO_PROTOCOL_LARGE_DATA_ACK_REQ) {
+            // a fragment of a large transfer, which is never queued
+            if (dest == radio_node) {
+                radio_rx_large_data(pkt, len);
+            }
+            return;
+        }
+    }
+
+    // drop the packet if it was received into the tx/rx buffer because the RX queue
+    // was full (a reliable packet is not ACKed, so the sender will retry)
+    if (pkt == MP_STATE_PORT(radio_buf)) {
+        ++radio_stats.rx_dropped;
+        return;
+    }
+
+    // drop the packet if the logical address it matched is over its quota
+    uint32_t addr = NRF_RADIO->RXMATCH & 7;
+    if (rx_quota[addr] != 0 && (uint16_t)(rx_addr_in[addr] - rx_addr_out[addr]) >= rx_quota[addr]) {
+        ++radio_stats.rx_dropped;
+        return;
+    }
+
+    if (reliable) {
+        // acknowledge the packet straight away, even if it's a duplicate (the
+        // previous ACK may have been lost)
+        uint8_t seq = pkt[4];
+        uint8_t src = pkt[5];
+        ack_buf[0] = MICROBIT_RADIO_RELIABLE_HEADER_LEN;
+        ack_buf[1] = 1;
+        ack_buf[2] = 0;
+        ack_buf[3] = RADIO_PROTOCOL_ACK;
+        ack_buf[4] = seq;
+        ack_buf[5] = radio_node;
+        ack_buf[6] = src;
+        tx_irq_pkt = ack_buf;
+
+        // suppress duplicates
+        size_t i;
+        for (i = 0; i < RADIO_RELIABLE_SEEN_LEN; ++i) {
+            if (reliable_seen[i].valid && reliable_seen[i].src == src) {
+                break;
+            }
+        }
+        if (i == RADIO_RELIABLE_SEEN_LEN) {
+            i = reliable_seen_next;
+            reliable_seen_next = (reliable_seen_next + 1) % RADIO_RELIABLE_SEEN_LEN;
+            reliable_seen[i].valid = true;
+            reliable_seen[i].src = src;
+        } else if (reliable_seen[i].seq == seq) {
+            ++radio_stats.rx_duplicates;
+            return;
+        }
+        reliable_seen[i].seq = seq;
+    }
+
+    if (burst) {
+        radio_set_seen(RADIO_PROTOCOL_BURST, pkt[5], pkt[4]);
+    }
+
+    if (header_len != 0) {
+        // strip the header so only the payload is queued
+        len -= header_len;
+        memmove(pkt + 1, pkt + 1 + header_len, len);
+        pkt[0] = len;
+    }
+
+    // store RSSI as last byte in packet (needs to be negated to get actual dBm value)
+    pkt[1 + len] = NRF_RADIO->RSSISAMPLE;
+
+    // get and store the microsecond timestamp, captured by PPI at the ADDRESS event
+    uint32_t time = MICROBIT_RADIO_TIMESTAMP_TIMER->CC[0] + rx_timestamp_offset;
+    pkt[1 + len + 1] = time & 0xff;
+    pkt[1 + len + 2] = (time >> 8) & 0xff;
+    pkt[1 + len + 3] = (time >> 16) & 0xff;
+    pkt[1 + len + 4] = (time >> 24) & 0xff;
+
+    // store the group (the prefix byte of the matched address) and the logical address
+    uint32_t prefix = addr < 4 ? NRF_RADIO->PREFIX0 : NRF_RADIO->PREFIX1;
+    MICROBIT_RADIO_PACKET_GROUP(pkt, len) = prefix >> (8 * (addr & 3));
+    MICROBIT_RADIO_PACKET_ADDR(pkt, len) = addr;
+    ++rx_addr_in[addr];
+
+    // store the channel the packet was received on
+    MICROBIT_RADIO_PACKET_CHANNEL(pkt, len) = NRF_RADIO->FREQUENCY;
+
+    // publish the slot to the consumer only once its contents are complete
+    radio_queue_push(&rx_queue);
+    ++radio_stats.rx_packets;
+
+    // Schedule the Python callback, if any.  Only one call is scheduled at a time
+    // so a flood of packets can't fill up the scheduler queue.
+    if (MP_STATE_PORT(radio_rx_callback) != MP_OBJ_NULL && !rx_callback_scheduled) {
+        rx_callback_scheduled = mp_sched_schedule(MP_OBJ_FROM_PTR(&radio_rx_callback_wrapper_obj), mp_const_none);
+    }
+}
+
+// The radio supports filtering packets at the hardware level based on an address.
+// We use a 5-byte address comprised of 4 bytes (set by BALEN=4) from the BASEx register,
+// plus 1 byte from PREFIXm.APn.  The (x,m,n) values are selected by the logical address.
+// Logical address 0 (BASE0 with PREFIX0.AP0) is used for transmitting and receiving on
+// the main group, and logical addresses 1-7 (BASE1 with PREFIXm.APn) are used to listen
+// on any extra groups.  BASE1 is set to the same value as BASE0 so that only the group
+// differs between them.
+static void radio_set_addresses(const microbit_radio_config_t *config) {
+    uint8_t prefixes[MICROBIT_RADIO_MAX_GROUPS] = { config->prefix0 };
+    memcpy(&prefixes[1], config->groups, config->num_groups);
+    NRF_RADIO->BASE0 = config->base0;
+    NRF_RADIO->BASE1 = config->base0;
+    NRF_RADIO->PREFIX0 = prefixes[0] | prefixes[1] << 8 | prefixes[2] << 16 | prefixes[3] << 24;
+    NRF_RADIO->PREFIX1 = prefixes[4] | prefixes[5] << 8 | prefixes[6] << 16 | prefixes[7] << 24;
+    NRF_RADIO->TXADDRESS = 0; // transmit on logical address 0
+    NRF_RADIO->RXADDRESSES = (1 << (1 + config->num_groups)) - 1; // a bit mask of logical addresses
+    memcpy(rx_quota, config->quotas, sizeof(rx_quota));
+    radio_node = config->node;
+    radio_node_set = config->node_set;
+    reliable_retries = config->retries;
+    relay_enabled = config->relay;
+}
+
+// Start the hop schedule from its first channel, which the caller has tuned to.
+// This must be called with the radio IRQ disabled.
+static void radio_hop_start(const microbit_radio_config_t *config) {
+    NRF_TIMER_Type *timer = MICROBIT_RADIO_TIMESTAMP_TIMER;
+    timer->INTENCLR = TIMER_INTENSET_COMPARE0_Msk << RADIO_HOP_TIMER_CC;
+    hop_num_channels = config->num_hops;
+    memcpy(hop_channels, config->hops, sizeof(hop_channels));
+    hop_index = 0;
+    hop_dwell_us = config->dwell_ms * 1000;
+    hop_pending = false;
+    if (hop_num_channels != 0) {
+        timer->TASKS_CAPTURE[RADIO_HOP_TIMER_CC] = 1;
+        timer->CC[RADIO_HOP_TIMER_CC] += hop_dwell_us;
+        timer->EVENTS_COMPARE[RADIO_HOP_TIMER_CC] = 0;
+        timer->INTENSET = TIMER_INTENSET_COMPARE0_Msk << RADIO_HOP_TIMER_CC;
+    }
+}
+
+// Change the radio state, adding the time spent in the old state to the duty
+// statistics.  These are timed with mp_hal_ticks_us() because the timestamp timer
+// is stopped between listen windows.
+static void radio_set_state(radio_state_t state) {
+    uint32_t now = mp_hal_ticks_us();
+    uint32_t dt = now - duty_last_time;
+    duty_last_time = now;
+    if (radio_state == RADIO_STATE_TX) {
+        radio_stats.tx_on_us += dt;
+    } else if (radio_state == RADIO_STATE_SLEEP) {
+        radio_stats.off_us += dt;
+    } else {
+        radio_stats.rx_on_us += dt;
+    }
+    radio_state = state;
+}
+
+// Start the HFXO, which the radio needs, and wait for it to run.  If it is already
+// running then something else wants it, so the radio leaves it alone.
+static void radio_hfxo_start(void) {
+    uint32_t stat = NRF_CLOCK->HFCLKSTAT;
+    if ((stat & CLOCK_HFCLKSTAT_STATE_Msk) && (stat & CLOCK_HFCLKSTAT_SRC_Msk)) {
+        return;
+    }
+    NRF_CLOCK->EVENTS_HFCLKSTARTED = 0;
+    NRF_CLOCK->TASKS_HFCLKSTART = 1;
+    while (NRF_CLOCK->EVENTS_HFCLKSTARTED == 0) {
+    }
+    radio_hfxo_started = true;
+}
+
+static void radio_hfxo_stop(void) {
+    if (radio_hfxo_started) {
+        radio_hfxo_started = false;
+        NRF_CLOCK->TASKS_HFCLKSTOP = 1;
+    }
+}
+
+// Start the timestamp timer and work out the offset from its count to
+// mp_hal_ticks_us().  The count is held while the timer is stopped, so pending
+// compares carry on where they left off.
+static void radio_timer_start(void) {
+    NRF_TIMER_Type *timer = MICROBIT_RADIO_TIMESTAMP_TIMER;
+    timer->TASKS_START = 1;
+    uint32_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    timer->TASKS_CAPTURE[1] = 1;
+    rx_timestamp_offset = mp_hal_ticks_us() - timer->CC[1];
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
+}
+
+// Go to sleep between listen windows, with the radio disabled.  Unless a relay
+// backoff or a hop schedule is being timed, nothing needs the HFXO or the timestamp
+// timer until the next window, so stop them to save power.
+static void radio_sleep(void) {
+    radio_set_state(RADIO_STATE_SLEEP);
+    NRF_RADIO->INTENCLR = RADIO_INTENSET_ADDRESS_Msk;
+    if (!relay_busy && hop_num_channels == 0) {
+        MICROBIT_RADIO_TIMESTAMP_TIMER->TASKS_STOP = 1;
+        radio_hfxo_stop();
+        duty_powered_down = true;
+    }
+}
+
+// Undo the power saving of radio_sleep(), before the radio is used again.  This
+// waits the few hundred microseconds the HFXO takes to start.
+static void radio_wake(void) {
+    if (duty_powered_down) {
+        duty_powered_down = false;
+        radio_hfxo_start();
+        radio_timer_start();
+    }
+}
+
+// Time the end of the listen window that has just opened.
+static void radio_duty_arm(void) {
+    NRF_TIMER_Type *timer = MICROBIT_RADIO_TIMESTAMP_TIMER;
+    timer->TASKS_CAPTURE[RADIO_DUTY_TIMER_CC] = 1;
+    timer->CC[RADIO_DUTY_TIMER_CC] += duty_window_ms * 1000;
+    timer->EVENTS_COMPARE[RADIO_DUTY_TIMER_CC] = 0;
+    timer->INTENSET = TIMER_INTENSET_COMPARE0_Msk << RADIO_DUTY_TIMER_CC;
+}
+
+// Retune to the next hop channel if one is due.  FREQUENCY takes effect at the next
+// ramp-up, so this must only be called while the radio is disabled.
+static void radio_hop_apply(void) {
+    if (hop_pending) {
+        hop_pending = false;
+        NRF_RADIO->FREQUENCY = hop_channels[hop_index];
+    }
+}
+
+// Enable the receiver from the disabled state, it starts via the shortcut.
+static void radio_rx_enable(void) {
+    radio_set_state(RADIO_STATE_RX);
+    NRF_RADIO->INTENCLR = RADIO_INTENSET_ADDRESS_Msk;
+    NRF_RADIO->SHORTS = RADIO_SHORTS_RX | RADIO_SHORTS_READY_START_Msk;
+    radio_rx_prepare();
+    NRF_RADIO->EVENTS_ADDRESS = 0;
+    NRF_RADIO->TASKS_RXEN = 1;
+}
+
+// Switch from receiving to transmitting.  The rest of the transmission is driven by
+// the ADDRESS, END and DISABLED events in the IRQ handler, with the radio shortcuts
+// doing the START after ramp-up and the DISABLE after the last packet.  While more
+// packets are queued the transmitter stays enabled and END->START sends them back
+// to back, without a ramp-down and ramp-up between each one.
+static void radio_tx_start(void) {
+    radio_set_state(RADIO_STATE_TX);
+    NRF_RADIO->SHORTS = RADIO_SHORTS_TX;
+    NRF_RADIO->EVENTS_ADDRESS = 0;
+    NRF_RADIO->INTENSET = RADIO_INTENSET_ADDRESS_Msk;
+    NRF_RADIO->TASKS_DISABLE = 1;
+}
+
+// With the radio disabled, ramp up the transmitter for the next packet, or go back
+// to listening (or sleeping) if there is nothing left to send.
+static void radio_tx_next(void) {
+    if (tx_irq_pkt != NULL) {
+        // send the packet from the IRQ first
+        NRF_RADIO->PACKETPTR = (uint32_t)tx_irq_pkt;
+        tx_irq_pkt_on_air = tx_irq_pkt;
+        tx_irq_pkt = NULL;
+        NRF_RADIO->TASKS_TXEN = 1;
+    } else if (tx_relay_pkt != NULL) {
+        NRF_RADIO->PACKETPTR = (uint32_t)tx_relay_pkt;
+        tx_irq_pkt_on_air = tx_relay_pkt;
+        tx_relay_pkt = NULL;
+        NRF_RADIO->TASKS_TXEN = 1;
+    } else if (radio_queue_count(&tx_queue) != 0) {
+        // ramp up the transmitter for the next packet, it starts via the shortcut
+        NRF_RADIO->PACKETPTR = (uint32_t)radio_queue_slot(&tx_queue, tx_queue.tail);
+        NRF_RADIO->TASKS_TXEN = 1;
+    } else if (duty_asleep) {
+        // TX queue drained outside a listen window, stay disabled
+        radio_sleep();
+    } else {
+        // TX queue drained, go back to listening
+        radio_rx_enable();
+    }
+}
 
 void microbit_radio_irq_handler(void) {
-    if (NRF_RADIO->EVENTS_READY) {
-        NRF_RADIO->EVENTS_READY = 0;
-        NRF_RADIO->TASKS_START = 1;
+    uint32_t isr_start = mp_hal_ticks_cpu();
+
+    // At the start of a listen window power up, and time the end of the window.
+    if (duty_opening) {
+        duty_opening = false;
+        radio_wake();
+        radio_duty_arm();
     }
 
+    // DISABLED follows END when the END->DISABLE shortcut is used, so sample it
+    // first: if both fire while this handler runs, END must be handled before the
+    // transmitter is ramped up again, or the packet that just ended would be resent.
+    bool disabled = NRF_RADIO->EVENTS_DISABLED;
+
     if (NRF_RADIO->EVENTS_END) {
         NRF_RADIO->EVENTS_END = 0;
 
-        size_t max_len = NRF_RADIO->PCNF1 & 0xff;
-        uint8_t *pkt = MP_STATE_PORT(radio_buf);
-        size_t len = pkt[0];
-        if (len > max_len) {
-            len = max_len;
-            pkt[0] = len;
+        if (radio_state == RADIO_STATE_RX) {
+            NRF_RADIO->EVENTS_ADDRESS = 0;
+            radio_rx_packet();
+            if (tx_irq_pkt == NULL && tx_relay_pkt == NULL && radio_queue_count(&tx_queue) == 0) {
+                radio_rx_start();
+            }
+        } else if (tx_irq_pkt_on_air != NULL) {
+            if (tx_irq_pkt_on_air == relay_buf) {
+                relay_busy = false;
+                ++radio_stats.relay_forwarded;
+            }
+            tx_irq_pkt_on_air = NULL;
+        } else {
+            // Free the slots of the packets that have been sent.  If the IRQ was late
+            // then ADDRESS and END events of a burst may have coalesced, so count the
+            // packets by the one PACKETPTR points at rather than by END events.  While
+            // the END->START shortcut is selected that packet has just been started
+            // by the shortcut and is still on air, otherwise it is the one that ended.
+            const uint8_t *ptr = (const uint8_t *)NRF_RADIO->PACKETPTR;
+            bool chained = NRF_RADIO->SHORTS & RADIO_SHORTS_END_START_Msk;
+            while (radio_queue_count(&tx_queue) != 0) {
+                const uint8_t *slot = radio_queue_slot(&tx_queue, tx_queue.tail);
+                if (slot == ptr && chained) {
+                    break;
+                }
+                radio_queue_pop(&tx_queue);
+                ++radio_stats.tx_packets;
+                if (slot == ptr) {
+                    break;
+                }
+            }
         }
+    }
 
-        // if the CRC was valid, and there's enough room in the RX queue, then accept the packet
-        if (NRF_RADIO->CRCSTATUS == 1 && rx_buf + RADIO_PACKET_OVERHEAD + len <= rx_buf_end) {
-            // copy the data to the queue
-            memcpy(rx_buf, pkt, 1 + len);
+    if (NRF_RADIO->EVENTS_ADDRESS && radio_state == RADIO_STATE_TX) {
+        NRF_RADIO->EVENTS_ADDRESS = 0;
 
-            // store RSSI as last byte in packet (needs to be negated to get actual dBm value)
-            rx_buf[1 + len] = NRF_RADIO->RSSISAMPLE;
+        // The packet at the tail of the TX queue is now on air, and PACKETPTR can be
+        // changed.  Decide what happens at its END: if another packet is queued then
+        // chain straight onto it, otherwise ramp down.
+        if (tx_irq_pkt_on_air == NULL && radio_queue_count(&tx_queue) >= 2) {
+            NRF_RADIO->PACKETPTR = (uint32_t)radio_queue_slot(&tx_queue, radio_queue_next(&tx_queue, tx_queue.tail));
+            NRF_RADIO->SHORTS = RADIO_SHORTS_TX_BURST;
+        } else {
+            NRF_RADIO->SHORTS = RADIO_SHORTS_TX;
+        }
+    }
 
-            // get and store the microsecond timestamp
-            uint32_t time = mp_hal_ticks_us();
-            rx_buf[1 + len + 1] = time & 0xff;
-            rx_buf[1 + len + 2] = (time >> 8) & 0xff;
-            rx_buf[1 + len + 3] = (time >> 16) & 0xff;
-            rx_buf[1 + len + 4] = (time >> 24) & 0xff;
+    if (disabled) {
+        NRF_RADIO->EVENTS_DISABLED = 0;
+        radio_hop_apply();
 
-            // move the RX queue pointer to end of this new packet
-            rx_buf += RADIO_PACKET_OVERHEAD + len;
+        if (radio_state == RADIO_STATE_DISABLING) {
+            if (duty_asleep) {
+                radio_sleep();
+            } else {
+                radio_rx_enable();
+            }
+        } else if (radio_state == RADIO_STATE_TX) {
+            radio_tx_next();
         }
+    }
+
+    // Start transmitting if there are packets queued, but don't cut off a packet that
+    // is currently being received (the ADDRESS event has fired but END has not).
+    bool tx_pending = tx_irq_pkt != NULL || tx_relay_pkt != NULL || radio_queue_count(&tx_queue) != 0;
+    if (radio_state == RADIO_STATE_RX && tx_pending && !NRF_RADIO->EVENTS_ADDRESS) {
+        radio_tx_start();
+    } else if (radio_state == RADIO_STATE_SLEEP && tx_pending) {
+        // the radio is already disabled, so go straight to ramping up the transmitter
+        radio_wake();
+        radio_hop_apply();
+        radio_set_state(RADIO_STATE_TX);
+        NRF_RADIO->SHORTS = RADIO_SHORTS_TX;
+        NRF_RADIO->EVENTS_ADDRESS = 0;
+        NRF_RADIO->INTENSET = RADIO_INTENSET_ADDRESS_Msk;
+        radio_tx_next();
+    }
+
+    // Likewise retune to the next hop channel or go to sleep, unless a transmission
+    // will do it, and wake up at the start of a listen window.
+    if (radio_state == RADIO_STATE_RX && (hop_pending || duty_asleep) && !NRF_RADIO->EVENTS_ADDRESS) {
+        radio_set_state(RADIO_STATE_DISABLING);
+        NRF_RADIO->SHORTS = 0;
+        NRF_RADIO->TASKS_DISABLE = 1;
+    } else if (radio_state == RADIO_STATE_SLEEP && !duty_asleep) {
+        radio_wake();
+        radio_hop_apply();
+        radio_rx_enable();
+    }
+
+    uint32_t isr_cycles = mp_hal_ticks_cpu() - isr_start;
+    radio_stats.isr_cycles_total += isr_cycles;
+    if (isr_cycles > radio_stats.isr_cycles_max) {
+        radio_stats.isr_cycles_max = isr_cycles;
+    }
+}
+
+// Handles the relay backoff expiring, the dwell time on a hop channel ending, and
+// a listen window closing.  This has the same priority as the radio IRQ so they don't preempt each other.
+void microbit_radio_timer_irq_handler(void) {
+    NRF_TIMER_Type *timer = MICROBIT_RADIO_TIMESTAMP_TIMER;
+    if (timer->EVENTS_COMPARE[RADIO_RELAY_TIMER_CC]) {
+        // hand the relay buffer to the radio IRQ
+        timer->EVENTS_COMPARE[RADIO_RELAY_TIMER_CC] = 0;
+        timer->INTENCLR = TIMER_INTENSET_COMPARE0_Msk << RADIO_RELAY_TIMER_CC;
+        tx_relay_pkt = relay_buf;
+        NVIC_SetPendingIRQ(RADIO_IRQn);
+    }
+    if (timer->EVENTS_COMPARE[RADIO_HOP_TIMER_CC]) {
+        // advance the schedule, the next compare is relative to this one so the
+        // hops don't drift with IRQ latency
+        timer->EVENTS_COMPARE[RADIO_HOP_TIMER_CC] = 0;
+        timer->CC[RADIO_HOP_TIMER_CC] += hop_dwell_us;
+        hop_index = hop_index + 1 == hop_num_channels ? 0 : hop_index + 1;
+        hop_pending = true;
+        NVIC_SetPendingIRQ(RADIO_IRQn);
+    }
+    if (timer->EVENTS_COMPARE[RADIO_DUTY_TIMER_CC]) {
+        // the radio IRQ disables the receiver, or does so once TX is done
+        timer->EVENTS_COMPARE[RADIO_DUTY_TIMER_CC] = 0;
+        timer->INTENCLR = TIMER_INTENSET_COMPARE0_Msk << RADIO_DUTY_TIMER_CC;
+        duty_asleep = true;
+        NVIC_SetPendingIRQ(RADIO_IRQn);
+    }
+}
+
+static bool radio_tx_busy(void) {
+    return radio_queue_count(&tx_queue) != 0
+        || (radio_state != RADIO_STATE_RX && radio_state != RADIO_STATE_SLEEP);
+}
+
+// Wait for the TX queue to drain without handling pending events, for use while
+// the radio is being reconfigured.  This is at most the air time of the queue.
+static void radio_tx_drain(void) {
+    while (radio_tx_busy()) {
+    }
+}
+
+// Handle pending events, such as a KeyboardInterrupt or scheduled callbacks, while
+// the interpreter waits on the radio.  A callback may turn the radio off or
+// reallocate its buffers, so this returns false if the buffers have been freed
+// since the given generation, in which case the wait must be abandoned.
+static bool radio_wait_poll(uint32_t generation) {
+    mp_handle_pending(true);
+    return radio_generation == generation;
+}
+
+// Called by the soft timer at the start of each listen window.  The soft timer
+// runs off the system tick, which wakes the CPU anyway, so it costs nothing while
+// the HFXO is stopped.  The radio IRQ wakes the radio and times the window's end.
+static void radio_duty_timer_callback(microbit_soft_timer_entry_t *entry) {
+    // if the timer fell behind, eg during a deep sleep, restart the cycle from now
+    uint32_t now = mp_hal_ticks_ms();
+    if (now - entry->expiry_ms > entry->delta_ms) {
+        entry->expiry_ms = now;
+    }
+    duty_asleep = false;
+    duty_opening = true;
+    NVIC_SetPendingIRQ(RADIO_IRQn);
+}
+
+// This must be called with the radio IRQ disabled and the radio powered up.
+static void radio_duty_stop(void) {
+    if (duty_interval_ms != 0) {
+        microbit_soft_timer_remove(&duty_timer);
+        duty_interval_ms = 0;
+    }
+    MICROBIT_RADIO_TIMESTAMP_TIMER->INTENCLR = TIMER_INTENSET_COMPARE0_Msk << RADIO_DUTY_TIMER_CC;
+    duty_asleep = false;
+    duty_opening = false;
+}
 
-        NRF_RADIO->TASKS_START = 1;
+// Start duty cycling, if configured, with a listen window.
+static void radio_duty_start(const microbit_radio_config_t *config) {
+    radio_duty_stop();
+    if (config->listen_interval != 0) {
+        duty_interval_ms = config->listen_interval;
+        duty_window_ms = config->listen_window;
+        radio_duty_arm();
+        duty_timer.flags = 0;
+        duty_timer.mode = MICROBIT_SOFT_TIMER_MODE_PERIODIC;
+        duty_timer.delta_ms = duty_interval_ms;
+        duty_timer.c_callback = radio_duty_timer_callback;
+        microbit_soft_timer_insert(&duty_timer, duty_interval_ms);
+    }
+}
+
+// Turn off the radio and free its buffers.  The RX callback and capture mode are
+// kept, so the radio can be re-enabled with new buffer sizes without losing them.
+static void radio_stop(void) {
+    if (MP_STATE_PORT(radio_buf) != NULL) {
+        // let any queued packets go out before turning off
+        radio_tx_drain();
+    }
+
+    NVIC_DisableIRQ(RADIO_IRQn);
+    radio_wake();
+    radio_duty_stop();
+    NRF_RADIO->EVENTS_DISABLED = 0;
+    NRF_RADIO->TASKS_DISABLE = 1;
+    while (NRF_RADIO->EVENTS_DISABLED == 0) {
+    }
+
+    // stop the RX timestamp timer, which also drives the relay backoff
+    NVIC_DisableIRQ(TIMER4_IRQn);
+    NRF_PPI->CHENCLR = 1 << MICROBIT_RADIO_TIMESTAMP_PPI_CH;
+    MICROBIT_RADIO_TIMESTAMP_TIMER->INTENCLR = 0xffffffff;
+    MICROBIT_RADIO_TIMESTAMP_TIMER->TASKS_STOP = 1;
+    radio_hfxo_stop();
+
+    // free any old buffers
+    if (MP_STATE_PORT(radio_buf) != NULL) {
+        size_t size = rx_queue.slot_size * (1 + rx_queue.len) + tx_queue.slot_size * (tx_queue.len + 1);
+        m_del(uint8_t, MP_STATE_PORT(radio_buf), size);
+        MP_STATE_PORT(radio_buf) = NULL;
+        ++radio_generation;
     }
 }
 
 void microbit_radio_enable(microbit_radio_config_t *config) {
-    microbit_radio_disable();
+    radio_stop();
 
-    // allocate tx and rx buffers
-    size_t max_payload = config->max_payload + RADIO_PACKET_OVERHEAD;
-    size_t queue_len = config->queue_len + 1; // one extra for tx/rx buffer
-    MP_STATE_PORT(radio_buf) = m_new(uint8_t, max_payload * queue_len);
-    rx_buf_end = MP_STATE_PORT(radio_buf) + max_payload * queue_len;
-    rx_buf = MP_STATE_PORT(radio_buf) + max_payload; // start is tx/rx buffer
+    // allocate tx and rx buffers, the start is the tx/rx buffer followed by the queues
+    size_t rx_slot_size = config->max_payload + RADIO_PACKET_OVERHEAD;
+    size_t tx_slot_size = 1 + config->max_payload;
+    size_t rx_queue_size = rx_slot_size * config->queue_len;
+    MP_STATE_PORT(radio_buf) = m_new(uint8_t, rx_slot_size + rx_queue_size + tx_slot_size * (config->tx_queue_len + 1));
+    radio_queue_init(&rx_queue, MP_STATE_PORT(radio_buf) + rx_slot_size, rx_slot_size, config->queue_len);
+    radio_queue_init(&tx_queue, rx_queue.buf + rx_queue_size, tx_slot_size, config->tx_queue_len);
+    relay_buf = tx_queue.buf + tx_slot_size * config->tx_queue_len; // the relay buffer is last
+    radio_state = RADIO_STATE_RX;
+    memset(&radio_stats, 0, sizeof(radio_stats));
+    memset(rx_addr_in, 0, sizeof(rx_addr_in));
+    memset((void *)rx_addr_out, 0, sizeof(rx_addr_out));
+    rx_callback_scheduled = false;
+    tx_irq_pkt = NULL;
+    tx_relay_pkt = NULL;
+    tx_irq_pkt_on_air = NULL;
+    reliable_ack_waiting = false;
+    memset(reliable_seen, 0, sizeof(reliable_seen));
+    large_tx_ack_waiting = false;
+    large_rx_buf = NULL;
+    large_rx_active = false;
+    relay_busy = false;
+    relay_rng_state = rng_generate_random_word() | 1;
+    memset(rx_seen, 0, sizeof(rx_seen));
 
     // Enable the High Frequency clock on the processor. This is a pre-requisite for
     // the RADIO module. Without this clock, no communication is possible.
-    NRF_CLOCK->EVENTS_HFCLKSTARTED = 0;
-    NRF_CLOCK->TASKS_HFCLKSTART = 1;
-    while (NRF_CLOCK->EVENTS_HFCLKSTARTED == 0) {
-    }
+    radio_hfxo_start();
+
+    // Start a free-running 1MHz timer, and capture it into CC[0] via PPI on every
+    // ADDRESS event so received packets get a timestamp free of IRQ latency.  Both
+    // this timer and the system timer behind mp_hal_ticks_us() run off HFCLK, so
+    // they don't drift and a fixed offset converts between them.
+    NRF_TIMER_Type *timer = MICROBIT_RADIO_TIMESTAMP_TIMER;
+    timer->TASKS_STOP = 1;
+    timer->MODE = TIMER_MODE_MODE_Timer;
+    timer->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    timer->PRESCALER = 4; // 16MHz / 2^4 = 1MHz
+    timer->TASKS_CLEAR = 1;
+    radio_timer_start();
+    duty_last_time = mp_hal_ticks_us();
+    NRF_PPI->CH[MICROBIT_RADIO_TIMESTAMP_PPI_CH].EEP = (uint32_t)&NRF_RADIO->EVENTS_ADDRESS;
+    NRF_PPI->CH[MICROBIT_RADIO_TIMESTAMP_PPI_CH].TEP = (uint32_t)&timer->TASKS_CAPTURE[0];
+    NRF_PPI->CHENSET = 1 << MICROBIT_RADIO_TIMESTAMP_PPI_CH;
 
     // power should be one of: -30, -20, -16, -12, -8, -4, 0, 4
     NRF_RADIO->TXPOWER = config->power_dbm;
 
     // should be between 0 and 100 inclusive (actual physical freq is 2400MHz + this register)
-    NRF_RADIO->FREQUENCY = config->channel;
+    NRF_RADIO->FREQUENCY = config->num_hops != 0 ? config->hops[0] : config->channel;
 
     // configure data rate
     NRF_RADIO->MODE = config->data_rate;
 
-    // The radio supports filtering packets at the hardware level based on an address.
-    // We use a 5-byte address comprised of 4 bytes (set by BALEN=4 below) from the BASEx
-    // register, plus 1 byte from PREFIXm.APn.
-    // The (x,m,n) values are selected by the logical address.  We use logical address 0
-    // which means using BASE0 with PREFIX0.AP0.
-    NRF_RADIO->BASE0 = config->base0;
-    NRF_RADIO->PREFIX0 = config->prefix0;
-    NRF_RADIO->TXADDRESS = 0; // transmit on logical address 0
-    NRF_RADIO->RXADDRESSES = 1; // a bit mask, listen only to logical address 0
+    // configure the addresses to transmit on and listen to
+    radio_set_addresses(config);
 
     // LFLEN=8 bits, S0LEN=0, S1LEN=0
     NRF_RADIO->PCNF0 = 0x00000008;
@@ -125,16 +1058,29 @@ void microbit_radio_enable(microbit_radio_config_t *config) {
     // Set the start random value of the data whitening algorithm. This can be any non zero number.
     NRF_RADIO->DATAWHITEIV = 0x18;
 
-    // Set the tx/rx packet buffer (must be in RAM).
-    NRF_RADIO->PACKETPTR = (uint32_t)MP_STATE_PORT(radio_buf);
+    // Set the packet buffer to receive into (must be in RAM).
+    radio_rx_prepare();
+
+    // Use fast ramp-up of the transmitter and receiver (40us instead of 140us).
+    NRF_RADIO->MODECNF0 = RADIO_MODECNF0_RU_Fast << RADIO_MODECNF0_RU_Pos;
 
     // configure interrupts
-    NRF_RADIO->INTENSET = 0x00000008;
+    NRF_RADIO->INTENCLR = 0xffffffff;
+    NRF_RADIO->INTENSET = RADIO_INTENSET_END_Msk | RADIO_INTENSET_DISABLED_Msk;
+    timer->INTENCLR = 0xffffffff;
+
+    // start the hop schedule and duty cycling before either IRQ can run
+    radio_hop_start(config);
+    radio_duty_start(config);
+
     NVIC_SetPriority(RADIO_IRQn, 3);
     NVIC_ClearPendingIRQ(RADIO_IRQn);
     NVIC_EnableIRQ(RADIO_IRQn);
+    NVIC_SetPriority(TIMER4_IRQn, 3);
+    NVIC_ClearPendingIRQ(TIMER4_IRQn);
+    NVIC_EnableIRQ(TIMER4_IRQn);
 
-    NRF_RADIO->SHORTS |= RADIO_SHORTS_ADDRESS_RSSISTART_Msk;
+    NRF_RADIO->SHORTS = RADIO_SHORTS_RX;
 
     // enable receiver
     NRF_RADIO->EVENTS_READY = 0;
@@ -143,26 +1089,24 @@ void microbit_radio_enable(microbit_radio_config_t *config) {
     }
 
     NRF_RADIO->EVENTS_END = 0;
+    NRF_RADIO->EVENTS_ADDRESS = 0;
     NRF_RADIO->TASKS_START = 1;
 }
 
 void microbit_radio_disable(void) {
-    NVIC_DisableIRQ(RADIO_IRQn);
-    NRF_RADIO->EVENTS_DISABLED = 0;
-    NRF_RADIO->TASKS_DISABLE = 1;
-    while (NRF_RADIO->EVENTS_DISABLED == 0) {
-    }
-
-    // free any old buffers
-    if (MP_STATE_PORT(radio_buf) != NULL) {
-        m_del(uint8_t, MP_STATE_PORT(radio_buf), rx_buf_end - MP_STATE_PORT(radio_buf));
-        MP_STATE_PORT(radio_buf) = NULL;
-    }
+    radio_stop();
+    MP_STATE_PORT(radio_rx_callback) = MP_OBJ_NULL;
+    microbit_radio_capture_stop();
 }
 
 void microbit_radio_update_config(microbit_radio_config_t *config) {
-    // disable radio
+    // let any queued packets go out with the old settings
+    radio_tx_drain();
+
+    // disable radio, powering it up if it is asleep between listen windows
     NVIC_DisableIRQ(RADIO_IRQn);
+    NVIC_DisableIRQ(TIMER4_IRQn);
+    radio_wake();
     NRF_RADIO->EVENTS_DISABLED = 0;
     NRF_RADIO->TASKS_DISABLE = 1;
     while (NRF_RADIO->EVENTS_DISABLED == 0) {
@@ -170,12 +1114,12 @@ void microbit_radio_update_config(microbit_radio_config_t *config) {
 
     // change state
     NRF_RADIO->TXPOWER = config->power_dbm;
-    NRF_RADIO->FREQUENCY = config->channel;
+    NRF_RADIO->FREQUENCY = config->num_hops != 0 ? config->hops[0] : config->channel;
     NRF_RADIO->MODE = config->data_rate;
-    NRF_RADIO->BASE0 = config->base0;
-    NRF_RADIO->PREFIX0 = config->prefix0;
+    radio_set_addresses(config);
 
     // need to set RXEN for FREQUENCY decision point
+    NRF_RADIO->SHORTS = RADIO_SHORTS_RX;
     NRF_RADIO->EVENTS_READY = 0;
     NRF_RADIO->TASKS_RXEN = 1;
     while (NRF_RADIO->EVENTS_READY == 0) {
@@ -183,24 +1127,26 @@ void microbit_radio_update_config(microbit_radio_config_t *config) {
 
     // need to set START for BASE0 and PREFIX0 decision point
     NRF_RADIO->EVENTS_END = 0;
-    NRF_RADIO->TASKS_START = 1;
+    NRF_RADIO->EVENTS_DISABLED = 0;
+    radio_set_state(RADIO_STATE_RX);
+    radio_rx_start();
+    radio_hop_start(config);
+    radio_duty_start(config);
 
     NVIC_ClearPendingIRQ(RADIO_IRQn);
     NVIC_EnableIRQ(RADIO_IRQn);
+    NVIC_EnableIRQ(TIMER4_IRQn);
 }
 
-// This assumes the radio is enabled.
+// This assumes the radio is enabled.  The packet is queued for transmission by the
+// radio IRQ and this function returns straight away, unless the TX queue is full in
+// which case it waits for a slot to become free.
 void microbit_radio_send(const void *buf, size_t len, const void *buf2, size_t len2) {
-    // transmission will occur synchronously
-    NVIC_DisableIRQ(RADIO_IRQn);
-
-    // Turn off the transceiver.
-    NRF_RADIO->EVENTS_DISABLED = 0;
-    NRF_RADIO->TASKS_DISABLE = 1;
-    while (NRF_RADIO->EVENTS_DISABLED == 0) {
+    // wait for a free slot, this is at most the air time of one packet
+    while (radio_queue_is_full(&tx_queue)) {
     }
 
-    // construct the packet
+    // construct the packet in the TX queue
     // note: we must send from RAM
     size_t max_len = NRF_RADIO->PCNF1 & 0xff;
     if (len + len2 > max_len) {
@@ -211,77 +1157,359 @@ void microbit_radio_send(const void *buf, size_t len, const void *buf2, size_t l
             len2 = max_len - len;
         }
     }
-    MP_STATE_PORT(radio_buf)[0] = len + len2;
-    memcpy(MP_STATE_PORT(radio_buf) + 1, buf, len);
+    uint8_t *slot = radio_queue_slot(&tx_queue, tx_queue.head);
+    slot[0] = len + len2;
+    memcpy(slot + 1, buf, len);
     if (len2 != 0) {
-        memcpy(MP_STATE_PORT(radio_buf) + 1 + len, buf2, len2);
+        memcpy(slot + 1 + len, buf2, len2);
     }
 
-    // Turn on the transmitter, and wait for it to signal that it's ready to use.
-    NRF_RADIO->EVENTS_READY = 0;
-    NRF_RADIO->TASKS_TXEN = 1;
-    while (NRF_RADIO->EVENTS_READY == 0) {
+    // publish the slot to the IRQ, and trigger it to start the transmission
+    radio_queue_push(&tx_queue);
+    NVIC_SetPendingIRQ(RADIO_IRQn);
+}
+
+// Send a packet to the given node and wait for it to be acknowledged, retransmitting
+// if needed.  Each retransmission waits for the ACK timeout plus a random backoff
+// that grows with the attempt number, so that nodes which collided don't retransmit
+// in lockstep.  This must be called with the scheduler locked.
+static bool radio_send_reliable(const void *buf, size_t len, uint8_t dest) {
+    size_t max_len = (NRF_RADIO->PCNF1 & 0xff) - MICROBIT_RADIO_RELIABLE_HEADER_LEN;
+    if (len > max_len) {
+        len = max_len;
     }
 
-    // Start transmission and wait for end of packet.
-    NRF_RADIO->TASKS_START = 1;
-    NRF_RADIO->EVENTS_END = 0;
-    while (NRF_RADIO->EVENTS_END == 0) {
+    // the time to wait for an ACK: both packets, both ramp-ups plus some margin
+    // for the receiver's IRQ latency
+    uint32_t ack_timeout_us = radio_air_time_us(MICROBIT_RADIO_RELIABLE_HEADER_LEN + len)
+        + radio_air_time_us(MICROBIT_RADIO_RELIABLE_HEADER_LEN) + 2 * 40 + 300;
+
+    uint8_t header[MICROBIT_RADIO_RELIABLE_HEADER_LEN] = { 1, 0, RADIO_PROTOCOL_RELIABLE, ++reliable_tx_seq, radio_node, dest };
+    reliable_ack_dest = dest;
+    reliable_acked = false;
+    reliable_ack_waiting = true;
+
+    uint32_t t_first = mp_hal_ticks_us();
+    for (size_t attempt = 0; attempt <= reliable_retries; ++attempt) {
+        if (attempt != 0) {
+            ++radio_stats.tx_retries;
+        }
+        microbit_radio_send(header, MICROBIT_RADIO_RELIABLE_HEADER_LEN, buf, len);
+        microbit_radio_tx_wait();
+        uint32_t t_sent = mp_hal_ticks_us();
+        uint32_t wait_us = ack_timeout_us;
+        if (attempt != 0) {
+            wait_us += rng_generate_random_word() % (attempt * ack_timeout_us);
+        }
+        while (!reliable_acked && mp_hal_ticks_us() - t_sent < wait_us) {
+            mp_handle_pending(true);
+        }
+        if (reliable_acked) {
+            uint32_t latency_us = mp_hal_ticks_us() - t_first;
+            ++radio_stats.tx_reliable_ok;
+            radio_stats.ack_latency_us_total += latency_us;
+            if (latency_us > radio_stats.ack_latency_us_max) {
+                radio_stats.ack_latency_us_max = latency_us;
+            }
+            return true;
+        }
     }
 
-    // Turn off the transmitter.
-    NRF_RADIO->EVENTS_DISABLED = 0;
-    NRF_RADIO->TASKS_DISABLE = 1;
-    while (NRF_RADIO->EVENTS_DISABLED == 0) {
+    reliable_ack_waiting = false;
+    ++radio_stats.tx_reliable_failed;
+    return false;
+}
+
+// This assumes the radio is enabled.  Send a reliable packet, returning true if it
+// was acknowledged.  Scheduled callbacks can't run while waiting for the ACK,
+// because one could start another send and take over the ACK state, but pending
+// exceptions such as KeyboardInterrupt are still raised.
+bool microbit_radio_send_reliable(const void *buf, size_t len, uint8_t dest) {
+    bool acked = false;
+    mp_sched_lock();
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        acked = radio_send_reliable(buf, len, dest);
+        nlr_pop();
+    } else {
+        reliable_ack_waiting = false;
+        mp_sched_unlock();
+        nlr_jump(nlr.ret_val);
     }
+    mp_sched_unlock();
+    return acked;
+}
 
-    // Start listening for the next packet
-    NRF_RADIO->EVENTS_READY = 0;
-    NRF_RADIO->TASKS_RXEN = 1;
-    while (NRF_RADIO->EVENTS_READY == 0) {
+// Send a buffer of up to 65535 bytes to the given node as a sequence of fragments.
+// A window of fragments is sent back to back, then the receiver's ACK says which of
+// them arrived and the window slides forward, resending only the missing ones.
+// This must be called with the scheduler locked.
+static bool radio_send_large(const uint8_t *buf, size_t len, uint8_t dest) {
+    size_t frag_size = (NRF_RADIO->PCNF1 & 0xff) - MICROBIT_RADIO_LARGE_HEADER_LEN;
+    size_t num_frags = len == 0 ? 1 : (len + frag_size - 1) / frag_size;
+
+    // the time to wait for an ACK after the last fragment: the ACK, both ramp-ups
+    // plus some margin for the receiver's IRQ latency
+    uint32_t ack_timeout_us = radio_air_time_us(RADIO_LARGE_ACK_LEN) + 2 * 40 + 300;
+
+    uint8_t header[MICROBIT_RADIO_LARGE_HEADER_LEN] = {
+        1, 0, RADIO_PROTOCOL_LARGE_DATA, ++large_tx_id, radio_node, dest,
+        0, 0, len & 0xff, len >> 8, frag_size,
+    };
+    large_tx_dest = dest;
+
+    size_t base = 0;
+    uint8_t bitmap = 0;
+    size_t attempt = 0;
+    while (base < num_frags) {
+        // find the last fragment in the window still to be sent, it requests an ACK
+        size_t end = MIN(base + RADIO_LARGE_WINDOW, num_frags);
+        size_t last = base;
+        for (size_t idx = base; idx < end; ++idx) {
+            if (!(bitmap & (1 << (idx - base)))) {
+                last = idx;
+            }
+        }
+
+        large_tx_acked = false;
+        large_tx_ack_waiting = true;
+        for (size_t idx = base; idx <= last; ++idx) {
+            if (bitmap & (1 << (idx - base))) {
+                continue;
+            }
+            size_t offset = idx * frag_size;
+            header[2] = idx == last ? RADIO_PROTOCOL_LARGE_DATA_ACK_REQ : RADIO_PROTOCOL_LARGE_DATA;
+            header[6] = idx & 0xff;
+            header[7] = idx >> 8;
+            microbit_radio_send(header, MICROBIT_RADIO_LARGE_HEADER_LEN, buf + offset, MIN(frag_size, len - offset));
+        }
+        microbit_radio_tx_wait();
+
+        uint32_t t_sent = mp_hal_ticks_us();
+        uint32_t wait_us = ack_timeout_us;
+        if (attempt != 0) {
+            wait_us += rng_generate_random_word() % (attempt * ack_timeout_us);
+        }
+        while (!large_tx_acked && mp_hal_ticks_us() - t_sent < wait_us) {
+            mp_handle_pending(true);
+        }
+
+        if (large_tx_acked && large_tx_ack_base > base) {
+            // progress was made
+            attempt = 0;
+        } else if (++attempt > reliable_retries) {
+            large_tx_ack_waiting = false;
+            return false;
+        }
+        if (large_tx_acked) {
+            // the receiver may go backwards if it restarted the transfer
+            base = MIN(large_tx_ack_base, num_frags);
+            bitmap = large_tx_ack_bitmap;
+        }
     }
 
-    NRF_RADIO->EVENTS_END = 0;
-    NRF_RADIO->TASKS_START = 1;
+    large_tx_ack_waiting = false;
+    return true;
+}
 
-    NVIC_ClearPendingIRQ(RADIO_IRQn);
-    NVIC_EnableIRQ(RADIO_IRQn);
+// This assumes the radio is enabled.  Send a large buffer, returning true if the
+// whole of it was acknowledged.  As for microbit_radio_send_reliable(), scheduled
+// callbacks can't run while the transfer is in progress.
+bool microbit_radio_send_large(const uint8_t *buf, size_t len, uint8_t dest) {
+    bool acked = false;
+    mp_sched_lock();
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        acked = radio_send_large(buf, len, dest);
+        nlr_pop();
+    } else {
+        large_tx_ack_waiting = false;
+        mp_sched_unlock();
+        nlr_jump(nlr.ret_val);
+    }
+    mp_sched_unlock();
+    return acked;
 }
 
-const uint8_t *microbit_radio_peek(void) {
-    // Disable the radio IRQ while we peek for packet.
+// Start receiving a large transfer into the given buffer.  If a transfer was
+// interrupted part way then it is started again.  Transfers longer than the buffer
+// are not accepted.
+void microbit_radio_receive_large_start(uint8_t *buf, size_t len) {
     NVIC_DisableIRQ(RADIO_IRQn);
+    if (large_rx_active && large_rx_base != large_rx_num_frags) {
+        large_rx_active = false;
+    }
+    large_rx_done = false;
+    large_rx_buf_len = len;
+    large_rx_buf = buf;
+    NVIC_EnableIRQ(RADIO_IRQn);
+}
 
-    // Get the pointer to the next waiting packet.
-    const uint8_t *buf = MP_STATE_PORT(radio_buf) + (NRF_RADIO->PCNF1 & 0xff) + RADIO_PACKET_OVERHEAD; // skip tx buf
+// Returns the total length of the transfer once it has been received, otherwise -1.
+// The whole transfer is in the buffer, because only transfers that fit are accepted.
+int microbit_radio_receive_large_poll(void) {
+    return large_rx_done ? large_rx_len : -1;
+}
 
-    // Return NULL if there are no packets waiting.
-    if (rx_buf == buf) {
-        buf = NULL;
+void microbit_radio_receive_large_stop(void) {
+    // The IRQ only reads the buffer pointer once per packet so it's safe to clear it here.
+    large_rx_buf = NULL;
+}
+
+// This assumes the radio is enabled.  Send a packet that other nodes with relay
+// enabled will rebroadcast, up to ttl hops.
+void microbit_radio_send_relay(const void *buf, size_t len, uint8_t ttl) {
+    size_t max_len = (NRF_RADIO->PCNF1 & 0xff) - MICROBIT_RADIO_RELAY_HEADER_LEN;
+    if (len > max_len) {
+        len = max_len;
     }
+    uint8_t header[MICROBIT_RADIO_RELAY_HEADER_LEN] = { 1, 0, RADIO_PROTOCOL_RELAY, ++relay_tx_seq, radio_node, ttl };
+    microbit_radio_send(header, MICROBIT_RADIO_RELAY_HEADER_LEN, buf, len);
+}
 
-    // Re-enable the radio IRQ.
-    NVIC_EnableIRQ(RADIO_IRQn);
+// Start capture mode with a ring buffer of the given size.  While capturing, the
+// radio records every packet it receives and doesn't queue, ACK or relay any.
+void microbit_radio_capture_start(size_t size) {
+    microbit_radio_capture_stop();
+    uint8_t *buf = m_new(uint8_t, size);
+    capture_size = size;
+    capture_head = 0;
+    capture_tail = 0;
+    __DMB();
+    MP_STATE_PORT(radio_capture_buf) = buf;
+}
 
-    return buf;
+void microbit_radio_capture_stop(void) {
+    uint8_t *buf = MP_STATE_PORT(radio_capture_buf);
+    if (buf != NULL) {
+        // The IRQ can't be part way through writing a record once this returns.
+        MP_STATE_PORT(radio_capture_buf) = NULL;
+        m_del(uint8_t, buf, capture_size);
+    }
 }
 
-void microbit_radio_pop(void) {
-    // Disable the radio IRQ while we pop the packet.
-    NVIC_DisableIRQ(RADIO_IRQn);
+// Returns the size of the capture ring, or 0 if not capturing.
+size_t microbit_radio_capture_size(void) {
+    return MP_STATE_PORT(radio_capture_buf) == NULL ? 0 : capture_size;
+}
+
+// Write all captured records to the given stream, straight from the ring buffer.
+// Returns the number of bytes written.  Only the bytes actually written are taken
+// off the ring, so after a short write the next drain carries on from the same
+// place in the record.  A stream error raises OSError, leaving the ring as it was.
+size_t microbit_radio_capture_drain(mp_obj_t stream) {
+    uint8_t *buf = MP_STATE_PORT(radio_capture_buf);
+    if (buf == NULL) {
+        return 0;
+    }
+    uint32_t head = capture_head;
+    uint32_t tail = capture_tail;
+    size_t total = 0;
+    while (tail != head) {
+        size_t offset = radio_capture_offset(tail);
+        size_t n = MIN(radio_capture_used(head, tail), capture_size - offset);
+        mp_obj_t ret = mp_stream_write(stream, buf + offset, n, MP_STREAM_RW_WRITE);
+        size_t written = ret == mp_const_none ? 0 : MP_OBJ_SMALL_INT_VALUE(ret);
+
+        // Make sure all reads of the ring are done before handing it back to the IRQ.
+        __DMB();
+        tail = radio_capture_advance(tail, written);
+        capture_tail = tail;
+        total += written;
+        if (written < n) {
+            // the stream can't take any more for now
+            break;
+        }
+    }
+    return total;
+}
+
+// This assumes the radio is enabled.  Send the same packet back to back for the
+// given duration, so that a receiver which is duty cycling with a listen interval
+// no longer than that duration will catch it.  Receivers drop the repeats.
+void microbit_radio_send_burst(const void *buf, size_t len, uint32_t duration_ms) {
+    size_t max_len = (NRF_RADIO->PCNF1 & 0xff) - MICROBIT_RADIO_BURST_HEADER_LEN;
+    if (len > max_len) {
+        len = max_len;
+    }
+    uint8_t header[MICROBIT_RADIO_BURST_HEADER_LEN] = { 1, 0, RADIO_PROTOCOL_BURST, ++burst_tx_seq, radio_node, 0 };
+    uint32_t generation = radio_generation;
+    uint32_t start_ms = mp_hal_ticks_ms();
+    do {
+        microbit_radio_send(header, MICROBIT_RADIO_BURST_HEADER_LEN, buf, len);
+        if (!radio_wait_poll(generation)) {
+            break;
+        }
+    } while (mp_hal_ticks_ms() - start_ms < duration_ms);
+}
+
+// Returns true if the radio is duty cycling and a listen window is open, in which
+// case the device should stay awake until the window closes.
+bool microbit_radio_duty_window_open(void) {
+    return duty_interval_ms != 0 && !duty_asleep;
+}
+
+// Returns the number of ms until the next listen window opens, 0 if one is open or
+// due, or UINT32_MAX if the radio is not duty cycling.  The soft timer that opens
+// the windows is paused during a deep sleep, so the sleep must end by then.
+uint32_t microbit_radio_duty_ms_to_window(void) {
+    if (duty_interval_ms == 0) {
+        return UINT32_MAX;
+    }
+    if (!duty_asleep) {
+        return 0;
+    }
+    int32_t dt = duty_timer.expiry_ms - mp_hal_ticks_ms();
+    return dt <= 0 ? 0 : dt;
+}
 
-    // Get the pointer to the next packet, skipping the TX buffer at the start.
-    uint8_t *buf = MP_STATE_PORT(radio_buf) + (NRF_RADIO->PCNF1 & 0xff) + RADIO_PACKET_OVERHEAD;
+size_t microbit_radio_tx_pending(void) {
+    return radio_queue_count(&tx_queue);
+}
 
-    if (rx_buf != buf) {
-        // Copy all subsequent packets down over the first one.
-        size_t len = buf[0];
-        memmove(buf, buf + RADIO_PACKET_OVERHEAD + len, rx_buf - (buf + RADIO_PACKET_OVERHEAD + len));
-        rx_buf -= RADIO_PACKET_OVERHEAD + len;
+// This assumes the radio is enabled.
+void microbit_radio_tx_wait(void) {
+    uint32_t generation = radio_generation;
+    while (radio_tx_busy()) {
+        if (!radio_wait_poll(generation)) {
+            break;
+        }
     }
+}
+
+// Peek and pop are only ever called from the interpreter, the single consumer of
+// the RX queue, so they can run concurrently with the radio IRQ.
 
-    // Re-enable the radio IRQ.
+void microbit_radio_set_rx_callback(mp_obj_t callback) {
+    MP_STATE_PORT(radio_rx_callback) = callback;
+}
+
+void microbit_radio_get_stats(microbit_radio_stats_t *stats) {
+    NVIC_DisableIRQ(RADIO_IRQn);
+    radio_set_state(radio_state); // bring the duty statistics up to date
+    *stats = radio_stats;
     NVIC_EnableIRQ(RADIO_IRQn);
 }
 
+const uint8_t *microbit_radio_peek(void) {
+    // Return NULL if there are no packets waiting.
+    if (radio_queue_count(&rx_queue) == 0) {
+        return NULL;
+    }
+
+    return radio_queue_slot(&rx_queue, rx_queue.tail);
+}
+
+void microbit_radio_pop(void) {
+    if (radio_queue_count(&rx_queue) != 0) {
+        const uint8_t *pkt = radio_queue_slot(&rx_queue, rx_queue.tail);
+        ++rx_addr_out[MICROBIT_RADIO_PACKET_ADDR(pkt, pkt[0])];
+
+        // all reads of the slot are done before it's handed back to the IRQ
+        radio_queue_pop(&rx_queue);
+    }
+}
+
 MP_REGISTER_ROOT_POINTER(uint8_t *radio_buf);
+MP_REGISTER_ROOT_POINTER(mp_obj_t radio_rx_callback);
+MP_REGISTER_ROOT_POINTER(uint8_t *radio_capture_buf);
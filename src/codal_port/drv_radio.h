@@ -30,11 +30,17 @@
 //  len  - byte
 //  data - "len" bytes
 //  RSSI - byte
-//  time - 4 bytes, little endian, microsecond timestamp
+//  time - 4 bytes, little endian, microsecond timestamp of the ADDRESS event
+//  group - byte, the group (address prefix) the packet was received on
+//  addr - byte, the logical address (0-7) the packet matched
+//  channel - byte, the channel (FREQUENCY) the packet was received on
 // Both "len" and "data" are written by the hardware, the others are computed.
 #define MICROBIT_RADIO_PACKET_LEN(p)        ((p)[0])
 #define MICROBIT_RADIO_PACKET_PAYLOAD(p)    (&(p)[1])
 #define MICROBIT_RADIO_PACKET_RSSI(p, len)  (-(p)[1 + len])
+#define MICROBIT_RADIO_PACKET_GROUP(p, len) ((p)[1 + len + 5])
+#define MICROBIT_RADIO_PACKET_ADDR(p, len)  ((p)[1 + len + 6])
+#define MICROBIT_RADIO_PACKET_CHANNEL(p, len) ((p)[1 + len + 7])
 /*
 #define MICROBIT_RADIO_PACKET_TIMESTAMP_US(p, len) 
         uint32_t timestamp_us = buf[1 + len + 1]
@@ -43,30 +49,114 @@
             | buf[1 + len + 4] << 24;
             */
 
+// Capture mode records each packet as an 8-byte header followed by the payload:
+//  len - byte, length of the payload
+//  flags - byte, see MICROBIT_RADIO_CAPTURE_FLAG_xxx
+//  RSSI - byte, needs to be negated to get the dBm value
+//  channel - byte, the FREQUENCY the packet was received on
+//  time - 4 bytes, little endian, microsecond timestamp of the ADDRESS event
+// The payload is raw, including any protocol header.
+#define MICROBIT_RADIO_CAPTURE_HEADER_LEN   (8)
+#define MICROBIT_RADIO_CAPTURE_FLAG_CRC_OK  (0x01)
+
 #define MICROBIT_RADIO_DEFAULT_MAX_PAYLOAD  (32)
 #define MICROBIT_RADIO_DEFAULT_QUEUE_LEN    (3)
+#define MICROBIT_RADIO_DEFAULT_TX_QUEUE_LEN (3)
 #define MICROBIT_RADIO_DEFAULT_CHANNEL      (7)
 #define MICROBIT_RADIO_DEFAULT_POWER_DBM    (0)
 #define MICROBIT_RADIO_DEFAULT_BASE0        (0x75626974) // "uBit"
 #define MICROBIT_RADIO_DEFAULT_PREFIX0      (0)
 #define MICROBIT_RADIO_DEFAULT_DATA_RATE    (RADIO_MODE_MODE_Nrf_1Mbit)
+#define MICROBIT_RADIO_DEFAULT_RETRIES      (3)
+#define MICROBIT_RADIO_DEFAULT_TTL          (4)
+#define MICROBIT_RADIO_DEFAULT_DWELL_MS     (10)
 
 #define MICROBIT_RADIO_MAX_CHANNEL          (83) // maximum allowed frequency is 2483.5 MHz
+#define MICROBIT_RADIO_MAX_GROUPS           (8) // one per logical address of the radio
+#define MICROBIT_RADIO_MAX_HOPS             (16)
+#define MICROBIT_RADIO_LARGE_HEADER_LEN     (11) // per-fragment overhead of a large transfer
+#define MICROBIT_RADIO_LARGE_MAX_LEN        (65535)
+#define MICROBIT_RADIO_BURST_HEADER_LEN     (6) // overhead of a burst packet
+#define MICROBIT_RADIO_RELAY_HEADER_LEN     (6) // overhead of a relayed packet
+#define MICROBIT_RADIO_RELIABLE_HEADER_LEN  (6) // overhead of a reliable packet
+
+// Timer and PPI channel used to capture the time of the ADDRESS event of received
+// packets.  The timer also times the relay backoff.  These are not used by CODAL
+// (it uses TIMER1-3 and leaves TIMER0 for the SoftDevice).
+#define MICROBIT_RADIO_TIMESTAMP_TIMER      NRF_TIMER4
+#define MICROBIT_RADIO_TIMESTAMP_PPI_CH     (19)
 
 typedef struct _microbit_radio_config_t {
     uint8_t max_payload;    // 1-251 inclusive
     uint8_t queue_len;      // 1-254 inclusive
+    uint8_t tx_queue_len;   // 1-254 inclusive
     uint8_t channel;        // 0-100 inclusive
     int8_t power_dbm;       // one of: -30, -20, -16, -12, -8, -4, 0, 4
     uint32_t base0;         // for BASE0 register
     uint8_t prefix0;        // for PREFIX0 register (lower 8 bits only)
+    uint8_t num_groups;     // number of extra groups to listen on, 0-7 inclusive
+    uint8_t groups[MICROBIT_RADIO_MAX_GROUPS - 1]; // prefixes for logical addresses 1-7
+    uint8_t quotas[MICROBIT_RADIO_MAX_GROUPS]; // max queued packets per logical address, 0 for no limit
+    uint8_t node;           // node id for the driver protocols, if node_set
+    uint8_t node_set;       // whether a node id is set, which turns on the driver protocols
+    uint8_t retries;        // max retransmissions in reliable mode, 0-15 inclusive
+    uint8_t relay;          // whether to rebroadcast relayed packets
+    uint8_t num_hops;       // number of channels in the hop schedule, 0 to not hop
+    uint8_t hops[MICROBIT_RADIO_MAX_HOPS]; // channels to hop between, in order
+    uint16_t dwell_ms;      // time spent on each hop channel, 1-65535 inclusive
+    uint16_t listen_interval; // period in ms of duty-cycled listening, 0 to listen continuously
+    uint16_t listen_window; // time in ms spent listening each period, less than listen_interval
     uint8_t data_rate;      // one of: RADIO_MODE_MODE_Nrf_{250Kbit,1Mbit,2Mbit}
 } microbit_radio_config_t;
 
+// Counters maintained by the driver, reset each time the radio is enabled.
+typedef struct _microbit_radio_stats_t {
+    uint32_t rx_packets;        // packets put on the RX queue
+    uint32_t rx_crc_errors;     // packets dropped due to a CRC error
+    uint32_t rx_dropped;        // packets dropped because the RX queue was full
+    uint32_t rx_truncated;      // packets longer than max_payload
+    uint32_t tx_packets;        // packets transmitted
+    uint32_t rx_duplicates;     // reliable and burst packets dropped as duplicates
+    uint32_t tx_reliable_ok;    // reliable packets acknowledged
+    uint32_t tx_reliable_failed; // reliable packets not acknowledged after all retries
+    uint32_t tx_retries;        // reliable packet retransmissions
+    uint32_t ack_latency_us_max; // longest time for a reliable packet to be acknowledged
+    uint32_t ack_latency_us_total; // total time for reliable packets to be acknowledged
+    uint32_t relay_forwarded;   // packets relayed
+    uint32_t relay_duplicates;  // relayed packets dropped because they were seen recently
+    uint32_t relay_expired;     // relayed packets not forwarded because their TTL ran out
+    uint32_t relay_dropped;     // relayed packets not forwarded because the relay buffer was busy
+    uint32_t capture_packets;   // packets recorded in capture mode
+    uint32_t capture_dropped;   // packets not recorded because the capture buffer was full
+    uint64_t rx_on_us;          // time the receiver was on
+    uint64_t tx_on_us;          // time the transmitter was on
+    uint64_t off_us;            // time the radio was off between listen windows
+    uint32_t isr_cycles_max;    // longest time spent in the radio IRQ, in CPU cycles
+    uint64_t isr_cycles_total;  // total time spent in the radio IRQ, in CPU cycles
+} microbit_radio_stats_t;
+
+void microbit_radio_timer_irq_handler(void);
 void microbit_radio_enable(microbit_radio_config_t *config);
 void microbit_radio_disable(void);
 void microbit_radio_update_config(microbit_radio_config_t *config);
 void microbit_radio_send(const void *buf, size_t len, const void *buf2, size_t len2);
+bool microbit_radio_send_reliable(const void *buf, size_t len, uint8_t dest);
+bool microbit_radio_send_large(const uint8_t *buf, size_t len, uint8_t dest);
+void microbit_radio_receive_large_start(uint8_t *buf, size_t len);
+int microbit_radio_receive_large_poll(void);
+void microbit_radio_receive_large_stop(void);
+void microbit_radio_send_relay(const void *buf, size_t len, uint8_t ttl);
+void microbit_radio_capture_start(size_t size);
+void microbit_radio_capture_stop(void);
+size_t microbit_radio_capture_size(void);
+size_t microbit_radio_capture_drain(mp_obj_t stream);
+void microbit_radio_send_burst(const void *buf, size_t len, uint32_t duration_ms);
+bool microbit_radio_duty_window_open(void);
+uint32_t microbit_radio_duty_ms_to_window(void);
+size_t microbit_radio_tx_pending(void);
+void microbit_radio_tx_wait(void);
+void microbit_radio_set_rx_callback(mp_obj_t callback);
+void microbit_radio_get_stats(microbit_radio_stats_t *stats);
 const uint8_t *microbit_radio_peek(void);
 void microbit_radio_pop(void);
 
@@ -0,0 +1,92 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MICROPY_INCLUDED_CODAL_PORT_DRV_RADIO_QUEUE_H
+#define MICROPY_INCLUDED_CODAL_PORT_DRV_RADIO_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The RX and TX queues are rings of fixed-size slots, each big enough to hold a
+// maximum length packet (plus its overhead for RX).  Each has a single producer and
+// a single consumer: for RX the radio IRQ advances the head and peek/pop advance the
+// tail, and for TX it is the other way around.  So neither side needs to mask the
+// other.  The indices run modulo twice the number of slots, which lets a full queue
+// be distinguished from an empty one without sacrificing a slot.
+//
+// This only depends on __DMB(), so it can also be built on the host, see
+// tests/host/radio_queue_test.c.
+typedef struct _radio_queue_t {
+    uint8_t *buf; // pointer to the first slot
+    size_t slot_size; // size in bytes of each slot
+    uint16_t len; // number of slots
+    volatile uint16_t head; // next slot to be written, 0 <= head < 2 * len
+    volatile uint16_t tail; // next slot to be read, 0 <= tail < 2 * len
+} radio_queue_t;
+
+static inline void radio_queue_init(radio_queue_t *q, uint8_t *buf, size_t slot_size, size_t len) {
+    q->buf = buf;
+    q->slot_size = slot_size;
+    q->len = len;
+    q->head = 0;
+    q->tail = 0;
+}
+
+static inline uint16_t radio_queue_next(const radio_queue_t *q, uint16_t idx) {
+    return idx + 1 == 2 * q->len ? 0 : idx + 1;
+}
+
+static inline size_t radio_queue_count(const radio_queue_t *q) {
+    uint16_t head = q->head;
+    uint16_t tail = q->tail;
+    return head >= tail ? head - tail : head + 2 * q->len - tail;
+}
+
+static inline bool radio_queue_is_full(const radio_queue_t *q) {
+    return radio_queue_count(q) == q->len;
+}
+
+static inline uint8_t *radio_queue_slot(const radio_queue_t *q, uint16_t idx) {
+    if (idx >= q->len) {
+        idx -= q->len;
+    }
+    return q->buf + idx * q->slot_size;
+}
+
+// Called by the producer once the slot at the head is complete, to publish it.
+static inline void radio_queue_push(radio_queue_t *q) {
+    __DMB();
+    q->head = radio_queue_next(q, q->head);
+}
+
+// Called by the consumer once it has finished with the slot at the tail, to hand
+// it back to the producer.
+static inline void radio_queue_pop(radio_queue_t *q) {
+    __DMB();
+    q->tail = radio_queue_next(q, q->tail);
+}
+
+#endif // MICROPY_INCLUDED_CODAL_PORT_DRV_RADIO_QUEUE_H
@@ -38,30 +38,48 @@ static int microbit_soft_timer_lt(mp_pairheap_t *n1, mp_pairheap_t *n2) {
     return TICKS_DIFF(e1->expiry_ms, e2->expiry_ms) < 0;
 }
 
+// Timers with a C callback belong to drivers, which may allocate them statically
+// and remove them when they are deinitialised.  They are kept in their own heap,
+// because the GC can only trace soft_timer_heap through heap-allocated entries.
+static microbit_soft_timer_entry_t *microbit_soft_timer_driver_heap = NULL;
+
+static microbit_soft_timer_entry_t **microbit_soft_timer_get_heap(microbit_soft_timer_entry_t *entry) {
+    if (entry->flags & MICROBIT_SOFT_TIMER_FLAG_PY_CALLBACK) {
+        return &MP_STATE_PORT(soft_timer_heap);
+    } else {
+        return &microbit_soft_timer_driver_heap;
+    }
+}
+
 void microbit_soft_timer_deinit(void) {
     MP_STATE_PORT(soft_timer_heap) = NULL;
     microbit_soft_timer_paused = false;
 }
 
-static void microbit_soft_timer_handler_run(bool run_callbacks) {
-    uint32_t ticks_ms = mp_hal_ticks_ms();
-    microbit_soft_timer_entry_t *heap = MP_STATE_PORT(soft_timer_heap);
+static microbit_soft_timer_entry_t *microbit_soft_timer_heap_run(microbit_soft_timer_entry_t *heap, uint32_t ticks_ms, bool run_callbacks) {
     while (heap != NULL && TICKS_DIFF(heap->expiry_ms, ticks_ms) <= 0) {
         microbit_soft_timer_entry_t *entry = heap;
         heap = (microbit_soft_timer_entry_t *)mp_pairheap_pop(microbit_soft_timer_lt, &heap->pairheap);
-        if (run_callbacks) {
-            if (entry->flags & MICROBIT_SOFT_TIMER_FLAG_PY_CALLBACK) {
+        if (entry->flags & MICROBIT_SOFT_TIMER_FLAG_PY_CALLBACK) {
+            if (run_callbacks) {
                 mp_sched_schedule(entry->py_callback, MP_OBJ_FROM_PTR(entry));
-            } else {
-                entry->c_callback(entry);
             }
+        } else {
+            // C callbacks belong to drivers and always run.
+            entry->c_callback(entry);
         }
         if (entry->mode == MICROBIT_SOFT_TIMER_MODE_PERIODIC) {
             entry->expiry_ms += entry->delta_ms;
             heap = (microbit_soft_timer_entry_t *)mp_pairheap_push(microbit_soft_timer_lt, &heap->pairheap, &entry->pairheap);
         }
     }
-    MP_STATE_PORT(soft_timer_heap) = heap;
+    return heap;
+}
+
+static void microbit_soft_timer_handler_run(bool run_callbacks) {
+    uint32_t ticks_ms = mp_hal_ticks_ms();
+    microbit_soft_timer_driver_heap = microbit_soft_timer_heap_run(microbit_soft_timer_driver_heap, ticks_ms, run_callbacks);
+    MP_STATE_PORT(soft_timer_heap) = microbit_soft_timer_heap_run(MP_STATE_PORT(soft_timer_heap), ticks_ms, run_callbacks);
 }
 
 // This function can be executed at interrupt priority.
@@ -74,8 +92,16 @@ void microbit_soft_timer_handler(void) {
 void microbit_soft_timer_insert(microbit_soft_timer_entry_t *entry, uint32_t initial_delta_ms) {
     mp_pairheap_init_node(microbit_soft_timer_lt, &entry->pairheap);
     entry->expiry_ms = mp_hal_ticks_ms() + initial_delta_ms;
+    microbit_soft_timer_entry_t **heap = microbit_soft_timer_get_heap(entry);
+    uint32_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    *heap = (microbit_soft_timer_entry_t *)mp_pairheap_push(microbit_soft_timer_lt, &(*heap)->pairheap, &entry->pairheap);
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
+}
+
+void microbit_soft_timer_remove(microbit_soft_timer_entry_t *entry) {
+    microbit_soft_timer_entry_t **heap = microbit_soft_timer_get_heap(entry);
     uint32_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
-    MP_STATE_PORT(soft_timer_heap) = (microbit_soft_timer_entry_t *)mp_pairheap_push(microbit_soft_timer_lt, &MP_STATE_PORT(soft_timer_heap)->pairheap, &entry->pairheap);
+    *heap = (microbit_soft_timer_entry_t *)mp_pairheap_delete(microbit_soft_timer_lt, &(*heap)->pairheap, &entry->pairheap);
     MICROPY_END_ATOMIC_SECTION(atomic_state);
 }
 
@@ -87,6 +113,7 @@ void microbit_soft_timer_set_pause(bool paused, bool run_callbacks) {
     microbit_soft_timer_paused = paused;
 }
 
+// Only timers with a Python callback are considered, drivers arrange their own wake-ups.
 uint32_t microbit_soft_timer_get_ms_to_next_expiry(void) {
     microbit_soft_timer_entry_t *heap = MP_STATE_PORT(soft_timer_heap);
     if (heap == NULL) {
@@ -51,6 +51,7 @@ extern bool microbit_outer_nlr_will_handle_soft_timer_exceptions;
 void microbit_soft_timer_deinit(void);
 void microbit_soft_timer_handler(void);
 void microbit_soft_timer_insert(microbit_soft_timer_entry_t *entry, uint32_t initial_delta_ms);
+void microbit_soft_timer_remove(microbit_soft_timer_entry_t *entry);
 void microbit_soft_timer_set_pause(bool paused, bool run_callbacks);
 uint32_t microbit_soft_timer_get_ms_to_next_expiry(void);
 
@@ -0,0 +1,118 @@
+"""
+Generate a header file with the printable ASCII glyphs of the CODAL system font
+pre-expanded into 5x5 monochrome images, so they can live in flash as constant
+Image objects.
+
+Usage: make_font_images_hdr.py <codal-core directory> <output header>
+"""
+
+import argparse
+import os
+import re
+import sys
+
+FONT_NAME = "pendolino3"
+FIRST_CHAR = 32
+LAST_CHAR = 126
+ROWS = 5
+COLS = 5
+
+
+def fail(msg):
+    print("error: make_font_images_hdr.py: {}".format(msg), file=sys.stderr)
+    sys.exit(1)
+
+
+def find_font_data(codal_core_dir):
+    # The font is scraped from the C source, so insist on exactly one definition.
+    pattern = re.compile(FONT_NAME + r"\s*\[\s*\d*\s*\]\s*=\s*\{(.*?)\}", re.DOTALL)
+    found = []
+    for root, dirs, files in os.walk(codal_core_dir):
+        for name in sorted(files):
+            if not name.endswith((".cpp", ".c", ".h")):
+                continue
+            path = os.path.join(root, name)
+            with open(path, encoding="utf-8", errors="ignore") as f:
+                match = pattern.search(f.read())
+            if match:
+                found.append((path, match.group(1)))
+    if not found:
+        fail("no {} font data found in {}".format(FONT_NAME, codal_core_dir))
+    if len(found) > 1:
+        paths = ", ".join(p for p, _ in found)
+        fail("{} defined in more than one file: {}".format(FONT_NAME, paths))
+    path, body = found[0]
+
+    # Strip comments, then parse the remaining integer literals.
+    body = re.sub(r"//[^\n]*|/\*.*?\*/", "", body, flags=re.DOTALL)
+    try:
+        return path, [int(v, 0) for v in body.replace(",", " ").split()]
+    except ValueError as er:
+        fail("can't parse {} font data in {}: {}".format(FONT_NAME, path, er))
+
+
+def check_font_data(path, data):
+    # One 5-row glyph per printable ASCII character, each row a byte whose low 5
+    # bits are the columns.
+    num_chars = LAST_CHAR - FIRST_CHAR + 1
+    if len(data) != num_chars * ROWS:
+        fail(
+            "{} in {} has {} values, expected {} glyphs of {} rows".format(
+                FONT_NAME, path, len(data), num_chars, ROWS
+            )
+        )
+    for i, row in enumerate(data):
+        if not 0 <= row <= 0xFF:
+            fail(
+                "{} in {} has a row that isn't a byte for {!r}".format(
+                    FONT_NAME, path, chr(FIRST_CHAR + i // ROWS)
+                )
+            )
+    if any(data[:ROWS]) or not any(data[ROWS:]):
+        fail(
+            "{} in {} doesn't look like a font, expected a blank space and other glyphs".format(
+                FONT_NAME, path
+            )
+        )
+
+
+def make_font_images_header(codal_core_dir, filename):
+    path, data = find_font_data(codal_core_dir)
+    check_font_data(path, data)
+    num_chars = LAST_CHAR - FIRST_CHAR + 1
+
+    lines = [
+        "// This file was generated by make_font_images_hdr.py",
+        "#define MICROBIT_FONT_FIRST_CHAR ({})".format(FIRST_CHAR),
+        "#define MICROBIT_FONT_LAST_CHAR ({})".format(LAST_CHAR),
+        "static const monochrome_5by5_t microbit_font_images[{}] = {{".format(num_chars),
+    ]
+    for i in range(num_chars):
+        rows = data[i * ROWS : (i + 1) * ROWS]
+        pixels = [(rows[y] >> (COLS - 1 - x)) & 1 for y in range(ROWS) for x in range(COLS)]
+        c = chr(FIRST_CHAR + i)
+        comment = repr(c) if c != "\\" else "backslash"
+        lines.append("    SMALL_IMAGE({}), // {}".format(",".join(str(p) for p in pixels), comment))
+    lines.append("};")
+    file_data = "\n".join(lines) + "\n"
+
+    # Only write the file if the contents changed, to avoid needless rebuilds.
+    if os.path.isfile(filename):
+        with open(filename) as f:
+            if f.read() == file_data:
+                return
+    os.makedirs(os.path.dirname(os.path.abspath(filename)), exist_ok=True)
+    with open(filename, "w") as f:
+        f.write(file_data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the constant font image header.")
+    parser.add_argument("codal_core_dir", help="path to the codal-core library")
+    parser.add_argument("filename", help="output header file")
+    args = parser.parse_args()
+    make_font_images_header(args.codal_core_dir, args.filename)
+
+
+if __name__ == "__main__":
+    main()
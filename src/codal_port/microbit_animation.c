@@ -0,0 +1,134 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "py/runtime.h"
+#include "py/objstr.h"
+#include "drv_display.h"
+
+typedef struct _microbit_animation_data_obj_t {
+    microbit_animation_obj_t animation;
+    uint8_t data[]; // delays (if any) followed by frames
+} microbit_animation_data_obj_t;
+
+static void animation_pack_frame(uint8_t *frame, mp_obj_t obj) {
+    if (MP_OBJ_IS_STR(obj)) {
+        mp_uint_t len;
+        const char *str = mp_obj_str_get_data(obj, &len);
+        if (len != 1) {
+            mp_raise_ValueError(MP_ERROR_TEXT("expecting a single character"));
+        }
+        obj = microbit_image_for_char(str[0]);
+    } else if (mp_obj_get_type(obj) != &microbit_image_type) {
+        mp_raise_TypeError(MP_ERROR_TEXT("not an image"));
+    }
+    // Pixels outside the image are blank, as for display.show().
+    microbit_image_obj_t *image = (microbit_image_obj_t *)obj;
+    mp_int_t w = MIN(image_width(image), MICROBIT_DISPLAY_WIDTH);
+    mp_int_t h = MIN(image_height(image), MICROBIT_DISPLAY_HEIGHT);
+    memset(frame, 0, MICROBIT_ANIMATION_FRAME_SIZE);
+    for (mp_int_t y = 0; y < h; ++y) {
+        for (mp_int_t x = 0; x < w; ++x) {
+            unsigned int index = y * MICROBIT_DISPLAY_WIDTH + x;
+            frame[index >> 1] |= image_get_pixel(image, x, y) << ((index & 1) * 4);
+        }
+    }
+}
+
+static mp_obj_t microbit_animation_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    enum { ARG_frames, ARG_delay };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_frames, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_delay, MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    size_t num_frames;
+    mp_obj_t *frames;
+    mp_obj_get_array(args[ARG_frames].u_obj, &num_frames, &frames);
+    if (num_frames > 0xffff) {
+        mp_raise_ValueError(MP_ERROR_TEXT("too many frames"));
+    }
+
+    // The delay may be None, a single value for all frames, or one value per frame.
+    mp_obj_t delay_in = args[ARG_delay].u_obj;
+    size_t num_delays = 0;
+    mp_obj_t *delays = NULL;
+    if (delay_in != mp_const_none) {
+        if (mp_obj_is_int(delay_in)) {
+            delays = &delay_in;
+        } else {
+            mp_obj_get_array(delay_in, &num_delays, &delays);
+            if (num_delays != num_frames) {
+                mp_raise_ValueError(MP_ERROR_TEXT("need one delay per frame"));
+            }
+        }
+    }
+
+    size_t delays_size = delays == NULL ? 0 : num_frames * sizeof(uint16_t);
+    microbit_animation_data_obj_t *self = m_new_obj_var(microbit_animation_data_obj_t, data, uint8_t,
+        delays_size + num_frames * MICROBIT_ANIMATION_FRAME_SIZE);
+    self->animation.base.type = type;
+    self->animation.num_frames = num_frames;
+    self->animation.delays = NULL;
+    self->animation.frames = self->data + delays_size;
+
+    if (delays != NULL) {
+        uint16_t *delay_data = (uint16_t *)self->data;
+        for (size_t i = 0; i < num_frames; ++i) {
+            mp_int_t delay = mp_obj_get_int(delays[num_delays == 0 ? 0 : i]);
+            if (delay < 0 || delay > 0xffff) {
+                mp_raise_ValueError(MP_ERROR_TEXT("delay out of range"));
+            }
+            delay_data[i] = delay;
+        }
+        self->animation.delays = delay_data;
+    }
+    for (size_t i = 0; i < num_frames; ++i) {
+        animation_pack_frame(self->data + delays_size + i * MICROBIT_ANIMATION_FRAME_SIZE, frames[i]);
+    }
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+static mp_obj_t microbit_animation_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
+    microbit_animation_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    switch (op) {
+        case MP_UNARY_OP_LEN:
+            return MP_OBJ_NEW_SMALL_INT(self->num_frames);
+        default:
+            return MP_OBJ_NULL; // op not supported
+    }
+}
+
+MP_DEFINE_CONST_OBJ_TYPE(
+    microbit_animation_type,
+    MP_QSTR_Animation,
+    MP_TYPE_FLAG_NONE,
+    make_new, microbit_animation_make_new,
+    unary_op, microbit_animation_unary_op
+    );
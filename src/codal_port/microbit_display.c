@@ -25,6 +25,7 @@
  */
 
 #include <math.h>
+#include <string.h>
 #include "py/runtime.h"
 #include "py/objstr.h"
 #include "py/mphal.h"
@@ -45,6 +46,7 @@ mp_obj_t microbit_display_show_func(mp_uint_t n_args, const mp_obj_t *pos_args,
         { MP_QSTR_clear, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
         { MP_QSTR_wait, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = true} },
         { MP_QSTR_loop, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+        { MP_QSTR_offset, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
     };
 
     // Parse the args.
@@ -60,11 +62,28 @@ mp_obj_t microbit_display_show_func(mp_uint_t n_args, const mp_obj_t *pos_args,
     // Cancel any animations.
     microbit_display_stop();
 
+    if (args[5].u_obj != mp_const_none) {
+        // Show a 5x5 viewport onto the image, which can be moved with set_offset().
+        if (mp_obj_get_type(image) != &microbit_image_type) {
+            mp_raise_TypeError(MP_ERROR_TEXT("expecting an image"));
+        }
+        mp_obj_t *offset;
+        mp_obj_get_array_fixed_n(args[5].u_obj, 2, &offset);
+        microbit_display_show_viewport((microbit_image_obj_t *)image, mp_obj_get_int(offset[0]), mp_obj_get_int(offset[1]));
+        return mp_const_none;
+    }
+
     // Convert to string from an integer or float if applicable
     if (mp_obj_is_integer(image) || mp_obj_is_float(image)) {
         image = mp_obj_str_make_new(&mp_type_str, 1, 0, &image);
     }
 
+    if (mp_obj_is_type(image, &microbit_animation_type)) {
+        // A packed animation is replayed by the display driver, and loops natively.
+        microbit_display_play(MP_OBJ_TO_PTR(image), delay, clear, loop, wait);
+        return mp_const_none;
+    }
+
     if (MP_OBJ_IS_STR(image)) {
         // arg is a string object
         mp_uint_t len;
@@ -176,7 +195,9 @@ void microbit_display_set_pixel(microbit_display_obj_t *display, mp_int_t x, mp_
     if (bright < 0 || bright > MICROBIT_DISPLAY_MAX_BRIGHTNESS) {
         mp_raise_ValueError(MP_ERROR_TEXT("brightness out of bounds"));
     }
-    microbit_hal_display_set_pixel(x, y, bright);
+    if (!microbit_display_hd_set_pixel(x, y, bright)) {
+        microbit_hal_display_set_pixel(x, y, bright);
+    }
 }
 
 static mp_obj_t microbit_display_set_pixel_func(mp_uint_t n_args, const mp_obj_t *args) {
@@ -191,6 +212,10 @@ mp_int_t microbit_display_get_pixel(microbit_display_obj_t *display, mp_int_t x,
     if (x < 0 || y < 0 || x >= MICROBIT_DISPLAY_WIDTH || y >= MICROBIT_DISPLAY_HEIGHT) {
         mp_raise_ValueError(MP_ERROR_TEXT("index out of bounds"));
     }
+    mp_int_t bright;
+    if (microbit_display_hd_get_pixel(x, y, &bright)) {
+        return bright;
+    }
     return microbit_hal_display_get_pixel(x, y);
 }
 
@@ -200,6 +225,59 @@ static mp_obj_t microbit_display_get_pixel_func(mp_obj_t self_in, mp_obj_t x_in,
 }
 MP_DEFINE_CONST_FUN_OBJ_3(microbit_display_get_pixel_obj, microbit_display_get_pixel_func);
 
+static mp_obj_t microbit_display_set_offset(mp_obj_t self_in, mp_obj_t x_in, mp_obj_t y_in) {
+    (void)self_in;
+    if (!microbit_display_move_viewport(mp_obj_get_int(x_in), mp_obj_get_int(y_in))) {
+        mp_raise_ValueError(MP_ERROR_TEXT("no image shown with an offset"));
+    }
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_3(microbit_display_set_offset_obj, microbit_display_set_offset);
+
+// display.show_levels(levels, *, fade=0): levels is 25 bytes of 0-255, or an Image.
+static mp_obj_t microbit_display_show_levels_func(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_levels, ARG_fade };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_levels, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_fade, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    if (args[ARG_fade].u_int < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("fade cannot be negative"));
+    }
+
+    mp_obj_t levels_in = args[ARG_levels].u_obj;
+    uint8_t levels[MICROBIT_DISPLAY_WIDTH * MICROBIT_DISPLAY_HEIGHT];
+    if (mp_obj_get_type(levels_in) == &microbit_image_type) {
+        // Scale image brightness 0-9 to the full range of levels.
+        microbit_image_obj_t *image = (microbit_image_obj_t *)levels_in;
+        memset(levels, 0, sizeof(levels));
+        for (mp_int_t y = 0; y < MIN(image_height(image), MICROBIT_DISPLAY_HEIGHT); ++y) {
+            for (mp_int_t x = 0; x < MIN(image_width(image), MICROBIT_DISPLAY_WIDTH); ++x) {
+                levels[y * MICROBIT_DISPLAY_WIDTH + x] = image_get_pixel(image, x, y) * 255 / MICROBIT_DISPLAY_MAX_BRIGHTNESS;
+            }
+        }
+    } else {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(levels_in, &bufinfo, MP_BUFFER_READ);
+        if (bufinfo.len != sizeof(levels)) {
+            mp_raise_ValueError(MP_ERROR_TEXT("expecting 25 levels"));
+        }
+        memcpy(levels, bufinfo.buf, sizeof(levels));
+    }
+    microbit_display_show_levels(levels, args[ARG_fade].u_int);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(microbit_display_show_levels_obj, 2, microbit_display_show_levels_func);
+
+static mp_obj_t microbit_display_late_frames(mp_obj_t self_in) {
+    (void)self_in;
+    return mp_obj_new_int_from_uint(microbit_display_get_late_frames());
+}
+MP_DEFINE_CONST_FUN_OBJ_1(microbit_display_late_frames_obj, microbit_display_late_frames);
+
 static mp_obj_t microbit_display_rotate(mp_obj_t self_in, mp_obj_t angle_in) {
     (void)self_in;
     mp_float_t angle_degrees = mp_obj_get_float(angle_in);
@@ -223,12 +301,15 @@ static const mp_rom_map_elem_t microbit_display_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_set_pixel), MP_ROM_PTR(&microbit_display_set_pixel_obj) },
     { MP_ROM_QSTR(MP_QSTR_show), MP_ROM_PTR(&microbit_display_show_obj) },
     { MP_ROM_QSTR(MP_QSTR_scroll), MP_ROM_PTR(&microbit_display_scroll_obj) },
+    { MP_ROM_QSTR(MP_QSTR_show_levels), MP_ROM_PTR(&microbit_display_show_levels_obj) },
+    { MP_ROM_QSTR(MP_QSTR_set_offset), MP_ROM_PTR(&microbit_display_set_offset_obj) },
     { MP_ROM_QSTR(MP_QSTR_clear), MP_ROM_PTR(&microbit_display_clear_obj) },
     { MP_ROM_QSTR(MP_QSTR_on), MP_ROM_PTR(&microbit_display_on_obj) },
     { MP_ROM_QSTR(MP_QSTR_off), MP_ROM_PTR(&microbit_display_off_obj) },
     { MP_ROM_QSTR(MP_QSTR_is_on), MP_ROM_PTR(&microbit_display_is_on_obj) },
     { MP_ROM_QSTR(MP_QSTR_read_light_level),MP_ROM_PTR(&microbit_display_read_light_level_obj) },
     { MP_ROM_QSTR(MP_QSTR_rotate),MP_ROM_PTR(&microbit_display_rotate_obj) },
+    { MP_ROM_QSTR(MP_QSTR_late_frames), MP_ROM_PTR(&microbit_display_late_frames_obj) },
 };
 static MP_DEFINE_CONST_DICT(microbit_display_locals_dict, microbit_display_locals_dict_table);
 
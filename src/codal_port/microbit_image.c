@@ -28,6 +28,7 @@
 #include "py/runtime.h"
 #include "py/mphal.h"
 #include "modmicrobit.h"
+#include "genhdr/fontimages.h"
 
 static void microbit_image_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
     microbit_image_obj_t *self = (microbit_image_obj_t*)self_in;
@@ -126,8 +127,8 @@ static mp_obj_t microbit_image_make_new(const mp_obj_type_t *type_in, mp_uint_t
                 const char *str = mp_obj_str_get_data(args[0], &len);
                 // make image from string
                 if (len == 1) {
-                    // For a single charater, return the font glyph
-                    return microbit_image_for_char(str[0]);
+                    // For a single charater, return a mutable copy of the font glyph
+                    return image_copy(microbit_image_for_char(str[0]));
                 } else {
                     // Otherwise parse the image description string
                     return image_from_parsed_str(str, len);
@@ -169,24 +170,8 @@ static mp_obj_t microbit_image_make_new(const mp_obj_type_t *type_in, mp_uint_t
     }
 }
 
-greyscale_t *image_shift(microbit_image_obj_t *self, mp_int_t x, mp_int_t y) {
-    int w = image_width(self);
-    int h = image_height(self);
-    greyscale_t *result = greyscale_new(w, h);
-    image_blit(self, result, x, y, w, h, 0, 0);
-    return result;
-}
-
-static microbit_image_obj_t *image_crop(microbit_image_obj_t *img, mp_int_t x, mp_int_t y, mp_int_t w, mp_int_t h) {
-    if (w < 0) {
-        w = 0;
-    }
-    if (h < 0) {
-        h = 0;
-    }
-    greyscale_t *result = greyscale_new(w, h);
-    image_blit(img, result, x, y, w, h, 0, 0);
-    return (microbit_image_obj_t *)result;
+static void image_shift(microbit_image_obj_t *self, greyscale_t *dest, mp_int_t x, mp_int_t y) {
+    image_blit(self, dest, x, y, image_width(self), image_height(self), 0, 0);
 }
 
 mp_obj_t microbit_image_width(mp_obj_t self_in) {
@@ -222,6 +207,23 @@ static void check_mutability(microbit_image_obj_t *self) {
     }
 }
 
+/* Return the image a result of size w x h is written to: a new image if out_in is
+ * None, otherwise out_in itself, which must be a mutable image of that size. */
+static greyscale_t *image_get_out(mp_obj_t out_in, mp_int_t w, mp_int_t h) {
+    if (out_in == mp_const_none) {
+        return greyscale_new(w, h);
+    }
+    if (mp_obj_get_type(out_in) != &microbit_image_type) {
+        mp_raise_TypeError(MP_ERROR_TEXT("expecting an image"));
+    }
+    microbit_image_obj_t *out = (microbit_image_obj_t *)out_in;
+    check_mutability(out);
+    if (out->greyscale.width != w || out->greyscale.height != h) {
+        mp_raise_ValueError(MP_ERROR_TEXT("images must be the same size"));
+    }
+    return &out->greyscale;
+}
+
 mp_obj_t microbit_image_set_pixel(mp_uint_t n_args, const mp_obj_t *args) {
     (void)n_args;
     microbit_image_obj_t *self = (microbit_image_obj_t *)args[0];
@@ -287,44 +289,61 @@ mp_obj_t microbit_image_blit(mp_uint_t n_args, const mp_obj_t *args) {
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(microbit_image_blit_obj, 6, 8, microbit_image_blit);
 
-mp_obj_t microbit_image_crop(mp_uint_t n_args, const mp_obj_t *args) {
-    (void)n_args;
-    microbit_image_obj_t *self = (microbit_image_obj_t *)args[0];
-    mp_int_t x0 = mp_obj_get_int(args[1]);
-    mp_int_t y0 = mp_obj_get_int(args[2]);
-    mp_int_t x1 = mp_obj_get_int(args[3]);
-    mp_int_t y1 = mp_obj_get_int(args[4]);
-    return image_crop(self, x0, y0, x1, y1);
+mp_obj_t microbit_image_crop(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_x, ARG_y, ARG_w, ARG_h, ARG_out };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_x, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_y, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_w, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_h, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_out, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    microbit_image_obj_t *self = (microbit_image_obj_t *)pos_args[0];
+    mp_int_t w = MAX(0, args[ARG_w].u_int);
+    mp_int_t h = MAX(0, args[ARG_h].u_int);
+    greyscale_t *result = image_get_out(args[ARG_out].u_obj, w, h);
+    image_blit(self, result, args[ARG_x].u_int, args[ARG_y].u_int, w, h, 0, 0);
+    return result;
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(microbit_image_crop_obj, 5, microbit_image_crop);
+
+// Shared by the shift_* methods: parse (self, n, *, out=None) and shift by n*dx, n*dy.
+static mp_obj_t image_shift_helper(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, mp_int_t dx, mp_int_t dy) {
+    enum { ARG_n, ARG_out };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_n, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_out, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    microbit_image_obj_t *self = (microbit_image_obj_t *)pos_args[0];
+    mp_int_t n = args[ARG_n].u_int;
+    greyscale_t *result = image_get_out(args[ARG_out].u_obj, image_width(self), image_height(self));
+    image_shift(self, result, n * dx, n * dy);
+    return result;
 }
-MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(microbit_image_crop_obj, 5, 5, microbit_image_crop);
 
-mp_obj_t microbit_image_shift_left(mp_obj_t self_in, mp_obj_t n_in) {
-    microbit_image_obj_t *self = (microbit_image_obj_t *)self_in;
-    mp_int_t n = mp_obj_get_int(n_in);
-    return image_shift(self, n, 0);
+mp_obj_t microbit_image_shift_left(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return image_shift_helper(n_args, pos_args, kw_args, 1, 0);
 }
-MP_DEFINE_CONST_FUN_OBJ_2(microbit_image_shift_left_obj, microbit_image_shift_left);
+MP_DEFINE_CONST_FUN_OBJ_KW(microbit_image_shift_left_obj, 2, microbit_image_shift_left);
 
-mp_obj_t microbit_image_shift_right(mp_obj_t self_in, mp_obj_t n_in) {
-    microbit_image_obj_t *self = (microbit_image_obj_t *)self_in;
-    mp_int_t n = mp_obj_get_int(n_in);
-    return image_shift(self, -n, 0);
+mp_obj_t microbit_image_shift_right(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return image_shift_helper(n_args, pos_args, kw_args, -1, 0);
 }
-MP_DEFINE_CONST_FUN_OBJ_2(microbit_image_shift_right_obj, microbit_image_shift_right);
+MP_DEFINE_CONST_FUN_OBJ_KW(microbit_image_shift_right_obj, 2, microbit_image_shift_right);
 
-mp_obj_t microbit_image_shift_up(mp_obj_t self_in, mp_obj_t n_in) {
-    microbit_image_obj_t *self = (microbit_image_obj_t *)self_in;
-    mp_int_t n = mp_obj_get_int(n_in);
-    return image_shift(self, 0, n);
+mp_obj_t microbit_image_shift_up(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return image_shift_helper(n_args, pos_args, kw_args, 0, 1);
 }
-MP_DEFINE_CONST_FUN_OBJ_2(microbit_image_shift_up_obj, microbit_image_shift_up);
+MP_DEFINE_CONST_FUN_OBJ_KW(microbit_image_shift_up_obj, 2, microbit_image_shift_up);
 
-mp_obj_t microbit_image_shift_down(mp_obj_t self_in, mp_obj_t n_in) {
-    microbit_image_obj_t *self = (microbit_image_obj_t *)self_in;
-    mp_int_t n = mp_obj_get_int(n_in);
-    return image_shift(self, 0, -n);
+mp_obj_t microbit_image_shift_down(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return image_shift_helper(n_args, pos_args, kw_args, 0, -1);
 }
-MP_DEFINE_CONST_FUN_OBJ_2(microbit_image_shift_down_obj, microbit_image_shift_down);
+MP_DEFINE_CONST_FUN_OBJ_KW(microbit_image_shift_down_obj, 2, microbit_image_shift_down);
 
 mp_obj_t microbit_image_copy(mp_obj_t self_in) {
     microbit_image_obj_t *self = (microbit_image_obj_t *)self_in;
@@ -332,11 +351,56 @@ mp_obj_t microbit_image_copy(mp_obj_t self_in) {
 }
 MP_DEFINE_CONST_FUN_OBJ_1(microbit_image_copy_obj, microbit_image_copy);
 
-mp_obj_t microbit_image_invert(mp_obj_t self_in) {
-    microbit_image_obj_t *self = (microbit_image_obj_t *)self_in;
-    return image_invert(self);
+mp_obj_t microbit_image_invert(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_out };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_out, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    microbit_image_obj_t *self = (microbit_image_obj_t *)pos_args[0];
+    greyscale_t *result = image_get_out(args[ARG_out].u_obj, image_width(self), image_height(self));
+    image_invert_into(self, result);
+    return result;
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(microbit_image_invert_obj, 1, microbit_image_invert);
+
+static microbit_image_obj_t *image_check(mp_obj_t obj) {
+    if (mp_obj_get_type(obj) != &microbit_image_type) {
+        mp_raise_TypeError(MP_ERROR_TEXT("expecting an image"));
+    }
+    return (microbit_image_obj_t *)obj;
+}
+
+// Image.blend_into(dst, a, b, *, subtract=False): write a + b (or a - b) into dst.
+static mp_obj_t microbit_image_blend_into(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_dst, ARG_a, ARG_b, ARG_subtract };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_dst, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_a, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_b, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_subtract, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    microbit_image_obj_t *a = image_check(args[ARG_a].u_obj);
+    microbit_image_obj_t *b = image_check(args[ARG_b].u_obj);
+    greyscale_t *dst = image_get_out(image_check(args[ARG_dst].u_obj), image_width(a), image_height(a));
+    microbit_image_sum_into(a, b, !args[ARG_subtract].u_bool, dst);
+    return mp_const_none;
 }
-MP_DEFINE_CONST_FUN_OBJ_1(microbit_image_invert_obj, microbit_image_invert);
+static MP_DEFINE_CONST_FUN_OBJ_KW(microbit_image_blend_into_obj, 3, microbit_image_blend_into);
+static MP_DEFINE_CONST_STATICMETHOD_OBJ(microbit_image_blend_into_staticmethod_obj, MP_ROM_PTR(&microbit_image_blend_into_obj));
+
+// Image.dim_into(dst, src, factor): write src * factor into dst.
+static mp_obj_t microbit_image_dim_into_func(mp_obj_t dst_in, mp_obj_t src_in, mp_obj_t factor_in) {
+    microbit_image_obj_t *src = image_check(src_in);
+    greyscale_t *dst = image_get_out(image_check(dst_in), image_width(src), image_height(src));
+    microbit_image_dim_into(src, mp_obj_get_float(factor_in), dst);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_3(microbit_image_dim_into_obj, microbit_image_dim_into_func);
+static MP_DEFINE_CONST_STATICMETHOD_OBJ(microbit_image_dim_into_staticmethod_obj, MP_ROM_PTR(&microbit_image_dim_into_obj));
 
 static const mp_rom_map_elem_t microbit_image_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_width), MP_ROM_PTR(&microbit_image_width_obj) },
@@ -352,6 +416,8 @@ static const mp_rom_map_elem_t microbit_image_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_invert), MP_ROM_PTR(&microbit_image_invert_obj) },
     { MP_ROM_QSTR(MP_QSTR_fill), MP_ROM_PTR(&microbit_image_fill_obj) },
     { MP_ROM_QSTR(MP_QSTR_blit), MP_ROM_PTR(&microbit_image_blit_obj) },
+    { MP_ROM_QSTR(MP_QSTR_blend_into), MP_ROM_PTR(&microbit_image_blend_into_staticmethod_obj) },
+    { MP_ROM_QSTR(MP_QSTR_dim_into), MP_ROM_PTR(&microbit_image_dim_into_staticmethod_obj) },
 
     { MP_ROM_QSTR(MP_QSTR_HEART), MP_ROM_PTR(&microbit_const_image_heart_obj) },
     { MP_ROM_QSTR(MP_QSTR_HEART_SMALL), MP_ROM_PTR(&microbit_const_image_heart_small_obj) },
@@ -422,55 +488,67 @@ static const mp_rom_map_elem_t microbit_image_locals_dict_table[] = {
 };
 static MP_DEFINE_CONST_DICT(microbit_image_locals_dict, microbit_image_locals_dict_table);
 
-static const unsigned char *get_font_data_from_char(char c) {
-    const uint8_t *data = microbit_hal_get_font_data(c);
-    if (data == NULL) {
-        data = microbit_hal_get_font_data('?');
+// Glyphs are pre-expanded into constant images at build time, so text can be
+// shown without allocating or calling into the font code in CODAL.
+static const monochrome_5by5_t *glyph_for_char(char c) {
+    if (c < MICROBIT_FONT_FIRST_CHAR || c > MICROBIT_FONT_LAST_CHAR) {
+        c = '?';
     }
-    return data;
-}
-
-static mp_int_t get_pixel_from_font_data(const unsigned char *data, int x, int y) {
-    // The following logic belongs in MicroBitFont
-    return ((data[y] >> (4 - x)) & 1);
+    return &microbit_font_images[c - MICROBIT_FONT_FIRST_CHAR];
 }
 
-static void microbit_image_set_from_char(greyscale_t *img, char c) {
-    const unsigned char *data = get_font_data_from_char(c);
-    for (int x = 0; x < MICROBIT_DISPLAY_WIDTH; ++x) {
-        for (int y = 0; y < MICROBIT_DISPLAY_HEIGHT; ++y) {
-            greyscale_set_pixel(img, x, y, get_pixel_from_font_data(data, x, y)*MICROBIT_DISPLAY_MAX_BRIGHTNESS);
-        }
-    }
+// Returns a shared constant image; copy it before modifying it.
+microbit_image_obj_t *microbit_image_for_char(char c) {
+    return (microbit_image_obj_t *)glyph_for_char(c);
 }
 
-microbit_image_obj_t *microbit_image_for_char(char c) {
-    greyscale_t *result = greyscale_new(MICROBIT_DISPLAY_WIDTH, MICROBIT_DISPLAY_HEIGHT);
-    microbit_image_set_from_char(result, c);
+microbit_image_obj_t *microbit_image_dim(microbit_image_obj_t *lhs, mp_float_t fval) {
+    greyscale_t *result = greyscale_new(image_width(lhs), image_height(lhs));
+    microbit_image_dim_into(lhs, fval, result);
     return (microbit_image_obj_t *)result;
 }
 
-microbit_image_obj_t *microbit_image_dim(microbit_image_obj_t *lhs, mp_float_t fval) {
+// The destination must be the same size as lhs, and may be lhs.
+void microbit_image_dim_into(microbit_image_obj_t *lhs, mp_float_t fval, greyscale_t *dest) {
     if (fval < 0) {
         mp_raise_ValueError(MP_ERROR_TEXT("brightness multiplier must not be negative"));
     }
-    greyscale_t *result = greyscale_new(image_width(lhs), image_height(lhs));
+    uint8_t map[16] = { 0 };
+    for (int i = 0; i <= MICROBIT_DISPLAY_MAX_BRIGHTNESS; ++i) {
+        map[i] = MIN(i * fval + 0.5, MICROBIT_DISPLAY_MAX_BRIGHTNESS);
+    }
+    if (!lhs->base.five) {
+        greyscale_map(dest, &lhs->greyscale, map);
+        return;
+    }
     for (int x = 0; x < image_width(lhs); ++x) {
-        for (int y = 0; y < image_width(lhs); ++y) {
-            int val = MIN((int)image_get_pixel(lhs, x, y) * fval + 0.5, MICROBIT_DISPLAY_MAX_BRIGHTNESS);
-            greyscale_set_pixel(result, x, y, val);
+        for (int y = 0; y < image_height(lhs); ++y) {
+            greyscale_set_pixel(dest, x, y, map[image_get_pixel(lhs, x, y)]);
         }
     }
-    return (microbit_image_obj_t *)result;
 }
 
 static microbit_image_obj_t *microbit_image_sum(microbit_image_obj_t *lhs, microbit_image_obj_t *rhs, bool add) {
+    greyscale_t *result = greyscale_new(image_width(lhs), image_height(lhs));
+    microbit_image_sum_into(lhs, rhs, add, result);
+    return (microbit_image_obj_t *)result;
+}
+
+// The destination must be the same size as lhs, and may be lhs or rhs.
+void microbit_image_sum_into(microbit_image_obj_t *lhs, microbit_image_obj_t *rhs, bool add, greyscale_t *dest) {
     mp_int_t h = image_height(lhs);
     mp_int_t w = image_width(lhs);
     if (image_height(rhs) != h || image_width(rhs) != w) {
         mp_raise_ValueError(MP_ERROR_TEXT("images must be the same size"));
     }
-    greyscale_t *result = greyscale_new(w, h);
+    if (!lhs->base.five && !rhs->base.five) {
+        if (add) {
+            greyscale_add(dest, &lhs->greyscale, &rhs->greyscale);
+        } else {
+            greyscale_sub(dest, &lhs->greyscale, &rhs->greyscale);
+        }
+        return;
+    }
     for (int x = 0; x < w; ++x) {
         for (int y = 0; y < h; ++y) {
             int val;
@@ -481,10 +559,9 @@ static microbit_image_obj_t *microbit_image_sum(microbit_image_obj_t *lhs, micro
             } else {
                 val = MAX(0, lval - rval);
             }
-            greyscale_set_pixel(result, x, y, val);
+            greyscale_set_pixel(dest, x, y, val);
         }
     }
-    return (microbit_image_obj_t *)result;
 }
 
 static mp_obj_t image_binary_op(mp_binary_op_t op, mp_obj_t lhs_in, mp_obj_t rhs_in) {
@@ -533,17 +610,24 @@ typedef struct _scrolling_string_t {
 typedef struct _scrolling_string_iterator_t {
     mp_obj_base_t base;
     mp_obj_t ref;
-    greyscale_t *img;
     char const *next_char;
     char const *start;
     char const *end;
+    // Columns of the current character, already positioned at column 4 of the frame.
+    uint32_t columns[MICROBIT_DISPLAY_WIDTH];
+    // Frame being scrolled, one bit per pixel in the same order as monochrome_5by5_t.
+    uint32_t frame;
     uint8_t offset;
     uint8_t offset_limit;
     bool monospace;
     bool repeat;
-    char right;
+    // Image returned for each step; lives inside the iterator so scrolling never allocates.
+    monochrome_5by5_t img;
 } scrolling_string_iterator_t;
 
+// Bit mask of the pixels in the rightmost column of a frame.
+#define SCROLL_FRAME_COLUMN_4 (1 << 4 | 1 << 9 | 1 << 14 | 1 << 19 | 1 << 24)
+
 extern const mp_obj_type_t microbit_scrolling_string_type;
 extern const mp_obj_type_t microbit_scrolling_string_iterator_type;
 
@@ -558,21 +642,21 @@ mp_obj_t scrolling_string_image_iterable(const char* str, mp_uint_t len, mp_obj_
     return result;
 }
 
-static int font_column_non_blank(const unsigned char *font_data, unsigned int col) {
-    for (int y = 0; y < MICROBIT_DISPLAY_HEIGHT; ++y) {
-        if (get_pixel_from_font_data(font_data, col, y)) {
-            return 1;
-        }
+static void load_char(scrolling_string_iterator_t *iter, char c) {
+    const monochrome_5by5_t *glyph = glyph_for_char(c);
+    uint32_t bits = glyph->bits24[0] | glyph->bits24[1] << 8 | glyph->bits24[2] << 16 | glyph->pixel44 << 24;
+    for (int x = 0; x < MICROBIT_DISPLAY_WIDTH; ++x) {
+        // Shift column x of the glyph over to column 4 of the frame.
+        iter->columns[x] = (bits << (4 - x)) & SCROLL_FRAME_COLUMN_4;
     }
-    return 0;
 }
 
 /* Not strictly the rightmost non-blank column, but the rightmost in columns 2,3 or 4. */
-static unsigned int rightmost_non_blank_column(const unsigned char *font_data) {
-    if (font_column_non_blank(font_data, 4)) {
+static unsigned int rightmost_non_blank_column(const uint32_t *columns) {
+    if (columns[4]) {
         return 4;
     }
-    if (font_column_non_blank(font_data, 3)) {
+    if (columns[3]) {
         return 3;
     }
     return 2;
@@ -581,15 +665,16 @@ static unsigned int rightmost_non_blank_column(const unsigned char *font_data) {
 static void restart(scrolling_string_iterator_t *iter) {
     iter->next_char = iter->start;
     iter->offset = 0;
+    iter->frame = 0;
     if (iter->start < iter->end) {
-        iter->right = *iter->next_char;
+        load_char(iter, *iter->next_char);
         if (iter->monospace) {
             iter->offset_limit = 5;
         } else {
-            iter->offset_limit = rightmost_non_blank_column(get_font_data_from_char(iter->right)) + 1;
+            iter->offset_limit = rightmost_non_blank_column(iter->columns) + 1;
         }
     } else {
-        iter->right = ' ';
+        load_char(iter, ' ');
         iter->offset_limit = 5;
     }
 }
@@ -599,7 +684,7 @@ static mp_obj_t get_microbit_scrolling_string_iter(mp_obj_t o_in, mp_obj_iter_bu
     scrolling_string_t *str = (scrolling_string_t *)o_in;
     scrolling_string_iterator_t *result = m_new_obj(scrolling_string_iterator_t);
     result->base.type = &microbit_scrolling_string_iterator_type;
-    result->img = greyscale_new(MICROBIT_DISPLAY_WIDTH, MICROBIT_DISPLAY_HEIGHT);
+    result->img = microbit_blank_image;
     result->start = str->str;
     result->ref = str->ref;
     result->monospace = str->monospace;
@@ -614,46 +699,38 @@ static mp_obj_t microbit_scrolling_string_iter_next(mp_obj_t o_in) {
     if (iter->next_char == iter->end && iter->offset == 5) {
         if (iter->repeat) {
             restart(iter);
-            greyscale_clear(iter->img);
         } else {
             return MP_OBJ_STOP_ITERATION;
         }
     }
-    for (int x = 0; x < 4; x++) {
-        for (int y = 0; y < MICROBIT_DISPLAY_HEIGHT; y++) {
-            greyscale_set_pixel(iter->img, x, y, greyscale_get_pixel(iter->img, x+1, y));
-        }
-    }
-    for (int y = 0; y < MICROBIT_DISPLAY_HEIGHT; y++) {
-        greyscale_set_pixel(iter->img, 4, y, 0);
-    }
-    const unsigned char *font_data;
+    // Move the frame one column to the left; bits leaving column 0 land in column 4
+    // of the row above, and are cleared along with the rest of that column.
+    iter->frame = (iter->frame >> 1) & ~SCROLL_FRAME_COLUMN_4;
     if (iter->offset < iter->offset_limit) {
-        font_data = get_font_data_from_char(iter->right);
-        for (int y = 0; y < MICROBIT_DISPLAY_HEIGHT; ++y) {
-            int pix = get_pixel_from_font_data(font_data, iter->offset, y)*MICROBIT_DISPLAY_MAX_BRIGHTNESS;
-            greyscale_set_pixel(iter->img, 4, y, pix);
-        }
+        iter->frame |= iter->columns[iter->offset];
     } else if (iter->offset == iter->offset_limit) {
         ++iter->next_char;
         if (iter->next_char == iter->end) {
-            iter->right = ' ';
+            load_char(iter, ' ');
             iter->offset_limit = 5;
             iter->offset = 0;
         } else {
-            iter->right = *iter->next_char;
-            font_data = get_font_data_from_char(iter->right);
+            load_char(iter, *iter->next_char);
             if (iter->monospace) {
                 iter->offset = -1;
                 iter->offset_limit = 5;
             } else {
-                iter->offset = -font_column_non_blank(font_data, 0);
-                iter->offset_limit = rightmost_non_blank_column(font_data)+1;
+                iter->offset = -(iter->columns[0] != 0);
+                iter->offset_limit = rightmost_non_blank_column(iter->columns) + 1;
             }
         }
     }
     ++iter->offset;
-    return iter->img;
+    iter->img.bits24[0] = iter->frame;
+    iter->img.bits24[1] = iter->frame >> 8;
+    iter->img.bits24[2] = iter->frame >> 16;
+    iter->img.pixel44 = iter->frame >> 24;
+    return &iter->img;
 }
 
 MP_DEFINE_CONST_OBJ_TYPE(
@@ -680,7 +757,6 @@ MP_DEFINE_CONST_OBJ_TYPE(
 typedef struct _string_image_facade_t {
     mp_obj_base_t base;
     mp_obj_t string;
-    greyscale_t *image;
 } string_image_facade_t;
 
 static mp_obj_t string_image_facade_subscr(mp_obj_t self_in, mp_obj_t index_in, mp_obj_t value) {
@@ -690,8 +766,7 @@ static mp_obj_t string_image_facade_subscr(mp_obj_t self_in, mp_obj_t index_in,
         mp_uint_t len;
         const char *text = mp_obj_str_get_data(self->string, &len);
         mp_uint_t index = mp_get_index(self->base.type, len, index_in, false);
-        microbit_image_set_from_char(self->image, text[index]);
-        return self->image;
+        return microbit_image_for_char(text[index]);
     } else {
         return MP_OBJ_NULL; // op not supported
     }
@@ -724,14 +799,12 @@ typedef struct _facade_iterator_t {
     mp_obj_base_t base;
     mp_obj_t string;
     mp_uint_t index;
-    greyscale_t *image;
 } facade_iterator_t;
 
 mp_obj_t microbit_string_facade(mp_obj_t string) {
     string_image_facade_t *result = m_new_obj(string_image_facade_t);
     result->base.type = &string_image_facade_type;
     result->string = string;
-    result->image = greyscale_new(MICROBIT_DISPLAY_WIDTH, MICROBIT_DISPLAY_HEIGHT);
     return result;
 }
 
@@ -742,9 +815,7 @@ static mp_obj_t microbit_facade_iter_next(mp_obj_t iter_in) {
     if (iter->index >= len) {
         return MP_OBJ_STOP_ITERATION;
     }
-    microbit_image_set_from_char(iter->image, text[iter->index]);
-    iter->index++;
-    return iter->image;
+    return microbit_image_for_char(text[iter->index++]);
 }
 
 MP_DEFINE_CONST_OBJ_TYPE(
@@ -760,7 +831,6 @@ static mp_obj_t microbit_facade_iterator(mp_obj_t iterable_in, mp_obj_iter_buf_t
     string_image_facade_t *iterable = (string_image_facade_t *)iterable_in;
     result->base.type = &microbit_facade_iterator_type;
     result->string = iterable->string;
-    result->image = iterable->image;
     result->index = 0;
     return result;
 }
@@ -31,10 +31,12 @@
 #include "modmicrobit.h"
 
 #define audio_source_iter MP_STATE_PORT(audio_source)
+#define audio_source_frame MP_STATE_PORT(audio_source_frame)
 
 #define DEFAULT_SAMPLE_RATE (7812)
 #define BUFFER_EXPANSION (4) // smooth out the samples via linear interpolation
-#define OUT_CHUNK_SIZE (BUFFER_EXPANSION * AUDIO_CHUNK_SIZE)
+#define OUT_FRAME_SAMPLES (128) // maximum number of frame samples expanded per output chunk
+#define OUT_CHUNK_SIZE (BUFFER_EXPANSION * OUT_FRAME_SAMPLES)
 
 typedef enum {
     AUDIO_OUTPUT_STATE_IDLE,
@@ -43,17 +45,18 @@ typedef enum {
 } audio_output_state_t;
 
 static uint8_t audio_output_buffer[OUT_CHUNK_SIZE];
+static size_t audio_output_len = OUT_CHUNK_SIZE;
+static size_t audio_source_frame_pos;
 static volatile audio_output_state_t audio_output_state;
 static volatile bool audio_fetcher_scheduled;
 
-microbit_audio_frame_obj_t *microbit_audio_frame_make_new(void);
-
 static inline bool audio_is_running(void) {
     return audio_source_iter != NULL;
 }
 
 void microbit_audio_stop(void) {
     audio_source_iter = NULL;
+    audio_source_frame = NULL;
     microbit_hal_audio_stop_expression();
 }
 
@@ -72,41 +75,58 @@ static void audio_data_fetcher(void) {
     if (audio_source_iter == NULL) {
         return;
     }
-    mp_obj_t buffer_obj;
-    nlr_buf_t nlr;
-    if (nlr_push(&nlr) == 0) {
-        buffer_obj = mp_iternext_allow_raise(audio_source_iter);
-        nlr_pop();
-    } else {
-        if (!mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(((mp_obj_base_t*)nlr.ret_val)->type),
-            MP_OBJ_FROM_PTR(&mp_type_StopIteration))) {
-            mp_sched_exception(MP_OBJ_FROM_PTR(nlr.ret_val));
+    if (audio_source_frame == NULL) {
+        // The previous frame has been fully consumed, so get the next one.
+        mp_obj_t buffer_obj;
+        nlr_buf_t nlr;
+        if (nlr_push(&nlr) == 0) {
+            buffer_obj = mp_iternext_allow_raise(audio_source_iter);
+            nlr_pop();
+        } else {
+            if (!mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(((mp_obj_base_t*)nlr.ret_val)->type),
+                MP_OBJ_FROM_PTR(&mp_type_StopIteration))) {
+                mp_sched_exception(MP_OBJ_FROM_PTR(nlr.ret_val));
+            }
+            buffer_obj = MP_OBJ_STOP_ITERATION;
+        }
+        if (buffer_obj == MP_OBJ_STOP_ITERATION) {
+            // End of audio iterator
+            microbit_audio_stop();
+            return;
+        } else if (mp_obj_get_type(buffer_obj) != &microbit_audio_frame_type) {
+            // Audio iterator did not return an AudioFrame
+            microbit_audio_stop();
+            mp_sched_exception(mp_obj_new_exception_msg(&mp_type_TypeError, MP_ERROR_TEXT("not an AudioFrame")));
+            return;
         }
-        buffer_obj = MP_OBJ_STOP_ITERATION;
+        audio_source_frame = (microbit_audio_frame_obj_t *)buffer_obj;
+        audio_source_frame_pos = 0;
     }
-    if (buffer_obj == MP_OBJ_STOP_ITERATION) {
-        // End of audio iterator
-        microbit_audio_stop();
-    } else if (mp_obj_get_type(buffer_obj) != &microbit_audio_frame_type) {
-        // Audio iterator did not return an AudioFrame
-        microbit_audio_stop();
-        mp_sched_exception(mp_obj_new_exception_msg(&mp_type_TypeError, MP_ERROR_TEXT("not an AudioFrame")));
-    } else {
-        microbit_audio_frame_obj_t *buffer = (microbit_audio_frame_obj_t *)buffer_obj;
-        uint8_t *dest = &audio_output_buffer[0];
-        uint32_t last = dest[BUFFER_EXPANSION * AUDIO_CHUNK_SIZE - 1];
-        for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i) {
-            uint32_t cur = buffer->data[i];
-            for (int j = 0; j < BUFFER_EXPANSION; ++j) {
-                // Get next sample with linear interpolation.
-                uint32_t sample = ((BUFFER_EXPANSION - 1 - j) * last + (j + 1) * cur) / BUFFER_EXPANSION;
-                // Write sample to the buffer.
-                *dest++ = sample;
-            }
-            last = cur;
+
+    // Expand the next part of the current frame into the output buffer.  Large
+    // frames are consumed over several output chunks, so the iterator is only
+    // called once per frame.
+    microbit_audio_frame_obj_t *buffer = audio_source_frame;
+    const uint8_t *src = &buffer->data[audio_source_frame_pos];
+    size_t len = MIN(buffer->size - audio_source_frame_pos, OUT_FRAME_SAMPLES);
+    audio_source_frame_pos += len;
+    if (audio_source_frame_pos >= buffer->size) {
+        audio_source_frame = NULL;
+    }
+    uint8_t *dest = &audio_output_buffer[0];
+    uint32_t last = dest[audio_output_len - 1];
+    for (size_t i = 0; i < len; ++i) {
+        uint32_t cur = src[i];
+        for (int j = 0; j < BUFFER_EXPANSION; ++j) {
+            // Get next sample with linear interpolation.
+            uint32_t sample = ((BUFFER_EXPANSION - 1 - j) * last + (j + 1) * cur) / BUFFER_EXPANSION;
+            // Write sample to the buffer.
+            *dest++ = sample;
         }
-        audio_buffer_ready();
+        last = cur;
     }
+    audio_output_len = BUFFER_EXPANSION * len;
+    audio_buffer_ready();
 }
 
 static mp_obj_t audio_data_fetcher_wrapper(mp_obj_t arg) {
@@ -118,7 +138,7 @@ static MP_DEFINE_CONST_FUN_OBJ_1(audio_data_fetcher_wrapper_obj, audio_data_fetc
 void microbit_hal_audio_ready_callback(void) {
     if (audio_output_state == AUDIO_OUTPUT_STATE_DATA_READY) {
         // there is data ready to send out to the audio pipeline, so send it
-        microbit_hal_audio_write_data(&audio_output_buffer[0], OUT_CHUNK_SIZE);
+        microbit_hal_audio_write_data(&audio_output_buffer[0], audio_output_len);
         audio_output_state = AUDIO_OUTPUT_STATE_DATA_WRITTEN;
     } else {
         // no data ready, need to call this function later when data is ready
@@ -260,15 +280,21 @@ MP_REGISTER_MODULE(MP_QSTR_audio, audio_module);
 
 static mp_obj_t microbit_audio_frame_new(const mp_obj_type_t *type_in, mp_uint_t n_args, mp_uint_t n_kw, const mp_obj_t *args) {
     (void)type_in;
-    (void)args;
-    mp_arg_check_num(n_args, n_kw, 0, 0, false);
-    return microbit_audio_frame_make_new();
+    mp_arg_check_num(n_args, n_kw, 0, 1, false);
+    mp_int_t size = AUDIO_CHUNK_SIZE;
+    if (n_args == 1) {
+        size = mp_obj_get_int(args[0]);
+        if (size <= 0 || size > AUDIO_FRAME_MAX_SIZE) {
+            mp_raise_ValueError(MP_ERROR_TEXT("size out of range"));
+        }
+    }
+    return microbit_audio_frame_make_new(size);
 }
 
 static mp_obj_t audio_frame_subscr(mp_obj_t self_in, mp_obj_t index_in, mp_obj_t value_in) {
     microbit_audio_frame_obj_t *self = (microbit_audio_frame_obj_t *)self_in;
     mp_int_t index = mp_obj_get_int(index_in);
-    if (index < 0 || index >= AUDIO_CHUNK_SIZE) {
+    if (index < 0 || index >= (mp_int_t)self->size) {
          mp_raise_ValueError(MP_ERROR_TEXT("index out of bounds"));
     }
     if (value_in == MP_OBJ_NULL) {
@@ -288,10 +314,10 @@ static mp_obj_t audio_frame_subscr(mp_obj_t self_in, mp_obj_t index_in, mp_obj_t
 }
 
 static mp_obj_t audio_frame_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
-    (void)self_in;
+    microbit_audio_frame_obj_t *self = (microbit_audio_frame_obj_t *)self_in;
     switch (op) {
         case MP_UNARY_OP_LEN:
-            return MP_OBJ_NEW_SMALL_INT(32);
+            return MP_OBJ_NEW_SMALL_INT(self->size);
         default:
             return MP_OBJ_NULL; // op not supported
     }
@@ -301,14 +327,17 @@ static mp_int_t audio_frame_get_buffer(mp_obj_t self_in, mp_buffer_info_t *bufin
     (void)flags;
     microbit_audio_frame_obj_t *self = (microbit_audio_frame_obj_t *)self_in;
     bufinfo->buf = self->data;
-    bufinfo->len = AUDIO_CHUNK_SIZE;
+    bufinfo->len = self->size;
     bufinfo->typecode = 'b';
     return 0;
 }
 
 static void add_into(microbit_audio_frame_obj_t *self, microbit_audio_frame_obj_t *other, bool add) {
+    if (self->size != other->size) {
+        mp_raise_ValueError(MP_ERROR_TEXT("size mismatch"));
+    }
     int mult = add ? 1 : -1;
-    for (int i = 0; i < AUDIO_CHUNK_SIZE; i++) {
+    for (size_t i = 0; i < self->size; i++) {
         unsigned val = (int)self->data[i] + mult*(other->data[i]-128);
         // Clamp to 0-255
         if (val > 255) {
@@ -319,10 +348,8 @@ static void add_into(microbit_audio_frame_obj_t *self, microbit_audio_frame_obj_
 }
 
 static microbit_audio_frame_obj_t *copy(microbit_audio_frame_obj_t *self) {
-    microbit_audio_frame_obj_t *result = microbit_audio_frame_make_new();
-    for (int i = 0; i < AUDIO_CHUNK_SIZE; i++) {
-        result->data[i] = self->data[i];
-    }
+    microbit_audio_frame_obj_t *result = microbit_audio_frame_make_new(self->size);
+    memcpy(result->data, self->data, self->size);
     return result;
 }
 
@@ -330,7 +357,7 @@ mp_obj_t copyfrom(mp_obj_t self_in, mp_obj_t other) {
     microbit_audio_frame_obj_t *self = (microbit_audio_frame_obj_t *)self_in;
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(other, &bufinfo, MP_BUFFER_READ);
-    uint32_t len = bufinfo.len > AUDIO_CHUNK_SIZE ? AUDIO_CHUNK_SIZE : bufinfo.len;
+    uint32_t len = MIN(bufinfo.len, self->size);
     for (uint32_t i = 0; i < len; i++) {
         self->data[i] = ((uint8_t *)bufinfo.buf)[i];
     }
@@ -367,7 +394,7 @@ int32_t float_to_fixed(float f, uint32_t scale) {
 
 static void mult(microbit_audio_frame_obj_t *self, float f) {
     int scaled = float_to_fixed(f, 15);
-    for (int i = 0; i < AUDIO_CHUNK_SIZE; i++) {
+    for (size_t i = 0; i < self->size; i++) {
         unsigned val = ((((int)self->data[i]-128) * scaled) >> 15)+128;
         if (val > 255) {
             val = (1-(val>>31))*255;
@@ -419,11 +446,13 @@ MP_DEFINE_CONST_OBJ_TYPE(
     locals_dict, &microbit_audio_frame_locals_dict
     );
 
-microbit_audio_frame_obj_t *microbit_audio_frame_make_new(void) {
-    microbit_audio_frame_obj_t *res = m_new_obj(microbit_audio_frame_obj_t);
+microbit_audio_frame_obj_t *microbit_audio_frame_make_new(size_t size) {
+    microbit_audio_frame_obj_t *res = m_new_obj_var(microbit_audio_frame_obj_t, data, uint8_t, size);
     res->base.type = &microbit_audio_frame_type;
-    memset(res->data, 128, AUDIO_CHUNK_SIZE);
+    res->size = size;
+    memset(res->data, 128, size);
     return res;
 }
 
 MP_REGISTER_ROOT_POINTER(void *audio_source);
+MP_REGISTER_ROOT_POINTER(struct _microbit_audio_frame_obj_t *audio_source_frame);
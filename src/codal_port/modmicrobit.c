@@ -167,6 +167,7 @@ static const mp_rom_map_elem_t microbit_module_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_microbit) },
 
     { MP_ROM_QSTR(MP_QSTR_Image), (mp_obj_t)&microbit_image_type },
+    { MP_ROM_QSTR(MP_QSTR_Animation), MP_ROM_PTR(&microbit_animation_type) },
     { MP_ROM_QSTR(MP_QSTR_Sound), MP_ROM_PTR(&microbit_sound_type) },
     { MP_ROM_QSTR(MP_QSTR_SoundEvent), (mp_obj_t)&microbit_soundevent_type },
 
@@ -27,6 +27,7 @@
 #include "py/runtime.h"
 #include "py/mphal.h"
 #include "drv_softtimer.h"
+#include "drv_radio.h"
 
 static size_t get_array(mp_obj_t *src, mp_obj_t **items) {
     if (*src == mp_const_none) {
@@ -108,8 +109,35 @@ static mp_obj_t power_deep_sleep(size_t n_args, const mp_obj_t *pos_args, mp_map
             }
         }
 
-        // Enter low power state.
-        bool interrupted = microbit_hal_power_deep_sleep(wake, ms);
+        bool interrupted = false;
+        if (microbit_radio_duty_window_open()) {
+            // The radio is in a duty-cycled listen window, so stay in light sleep to
+            // keep it receiving.  A timer compare closes the window, after which the
+            // loop goes round to deep sleep.  Only the deep sleep checks the wake
+            // sources, so check them here too.
+            uint32_t idle_start_ms = mp_hal_ticks_ms();
+            while (microbit_radio_duty_window_open()) {
+                if (microbit_hal_power_wake_source_active()) {
+                    interrupted = true;
+                    break;
+                }
+                if (wake && mp_hal_ticks_ms() - idle_start_ms >= ms) {
+                    break;
+                }
+                microbit_hal_idle();
+            }
+        } else {
+            // A duty-cycled radio must wake for its next listen window, whether or
+            // not run_every is true, because the soft timer that opens it is paused.
+            uint32_t radio_ms = microbit_radio_duty_ms_to_window();
+            if (radio_ms < ms) {
+                wake = true;
+                ms = radio_ms;
+            }
+
+            // Enter low power state.
+            interrupted = microbit_hal_power_deep_sleep(wake, ms);
+        }
 
         // Resume the soft timer, and run outstanding events if run_every=True.
         microbit_soft_timer_set_pause(false, args[ARG_run_every].u_bool);
@@ -30,6 +30,7 @@
 #include "py/runtime.h"
 #include "py/mphal.h"
 #include "py/smallint.h"
+#include "py/stream.h"
 #include "drv_radio.h"
 
 static microbit_radio_config_t radio_config;
@@ -42,6 +43,16 @@ static void ensure_enabled(void) {
     }
 }
 
+// The reliable, large, relay and burst protocols need this device's node id.  Ids
+// are only 8 bits, so they must be assigned uniquely with config(node=...) rather
+// than derived from the device id, which would make collisions likely in a network
+// of tens of nodes.
+static void ensure_node(void) {
+    if (!radio_config.node_set) {
+        mp_raise_ValueError(MP_ERROR_TEXT("node is not set"));
+    }
+}
+
 static mp_obj_t mod_radio___init__(void) {
     mod_radio_reset();
     microbit_radio_enable(&radio_config);
@@ -52,15 +63,45 @@ MP_DEFINE_CONST_FUN_OBJ_0(mod_radio___init___obj, mod_radio___init__);
 static mp_obj_t mod_radio_reset(void) {
     radio_config.max_payload = MICROBIT_RADIO_DEFAULT_MAX_PAYLOAD;
     radio_config.queue_len = MICROBIT_RADIO_DEFAULT_QUEUE_LEN;
+    radio_config.tx_queue_len = MICROBIT_RADIO_DEFAULT_TX_QUEUE_LEN;
     radio_config.channel = MICROBIT_RADIO_DEFAULT_CHANNEL;
     radio_config.power_dbm = MICROBIT_RADIO_DEFAULT_POWER_DBM;
     radio_config.base0 = MICROBIT_RADIO_DEFAULT_BASE0;
     radio_config.prefix0 = MICROBIT_RADIO_DEFAULT_PREFIX0;
+    radio_config.num_groups = 0;
+    radio_config.node = 0;
+    radio_config.node_set = false;
+    radio_config.retries = MICROBIT_RADIO_DEFAULT_RETRIES;
+    radio_config.relay = false;
+    radio_config.num_hops = 0;
+    radio_config.dwell_ms = MICROBIT_RADIO_DEFAULT_DWELL_MS;
+    radio_config.listen_interval = 0;
+    radio_config.listen_window = 0;
+    memset(radio_config.quotas, 0, sizeof(radio_config.quotas));
     radio_config.data_rate = MICROBIT_RADIO_DEFAULT_DATA_RATE;
     return mp_const_none;
 }
 MP_DEFINE_CONST_FUN_OBJ_0(mod_radio_reset_obj, mod_radio_reset);
 
+// Get a sequence of at most max_len values in the range 0-255.
+// Returns the length of the sequence, or -1 if it's not valid.
+static int get_byte_seq(mp_obj_t seq_in, uint8_t *dest, size_t max_len) {
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_get_array(seq_in, &len, &items);
+    if (len > max_len) {
+        return -1;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        mp_int_t value = mp_obj_get_int(items[i]);
+        if (!(0 <= value && value <= 255)) {
+            return -1;
+        }
+        dest[i] = value;
+    }
+    return len;
+}
+
 static mp_obj_t mod_radio_config(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     (void)pos_args; // unused
 
@@ -74,8 +115,45 @@ static mp_obj_t mod_radio_config(size_t n_args, const mp_obj_t *pos_args, mp_map
     qstr arg_name = MP_QSTR_;
     for (size_t i = 0; i < kw_args->alloc; ++i) {
         if (MP_MAP_SLOT_IS_FILLED(kw_args, i)) {
-            mp_int_t value = mp_obj_get_int_truncated(kw_args->table[i].value);
+            mp_obj_t value_in = kw_args->table[i].value;
             arg_name = mp_obj_str_get_qstr(kw_args->table[i].key);
+
+            // arguments that take a sequence of values
+            if (arg_name == MP_QSTR_groups) {
+                int len = get_byte_seq(value_in, new_config.groups, MICROBIT_RADIO_MAX_GROUPS - 1);
+                if (len < 0) {
+                    goto value_error;
+                }
+                new_config.num_groups = len;
+                continue;
+            } else if (arg_name == MP_QSTR_quotas) {
+                uint8_t quotas[MICROBIT_RADIO_MAX_GROUPS] = {0};
+                if (get_byte_seq(value_in, quotas, MICROBIT_RADIO_MAX_GROUPS) < 0) {
+                    goto value_error;
+                }
+                memcpy(new_config.quotas, quotas, sizeof(quotas));
+                continue;
+            } else if (arg_name == MP_QSTR_hop) {
+                uint8_t hops[MICROBIT_RADIO_MAX_HOPS];
+                int len = get_byte_seq(value_in, hops, MICROBIT_RADIO_MAX_HOPS);
+                if (len < 0) {
+                    goto value_error;
+                }
+                for (int j = 0; j < len; ++j) {
+                    if (hops[j] > MICROBIT_RADIO_MAX_CHANNEL) {
+                        goto value_error;
+                    }
+                }
+                memcpy(new_config.hops, hops, len);
+                new_config.num_hops = len;
+                continue;
+            } else if (arg_name == MP_QSTR_node && value_in == mp_const_none) {
+                // turn off the driver protocols
+                new_config.node_set = false;
+                continue;
+            }
+
+            mp_int_t value = mp_obj_get_int_truncated(value_in);
             switch (arg_name) {
                 case MP_QSTR_length:
                     if (!(1 <= value && value <= 251)) {
@@ -91,6 +169,13 @@ static mp_obj_t mod_radio_config(size_t n_args, const mp_obj_t *pos_args, mp_map
                     new_config.queue_len = value;
                     break;
 
+                case MP_QSTR_tx_queue:
+                    if (!(1 <= value && value <= 254)) {
+                        goto value_error;
+                    }
+                    new_config.tx_queue_len = value;
+                    break;
+
                 case MP_QSTR_channel:
                     if (!(0 <= value && value <= MICROBIT_RADIO_MAX_CHANNEL)) {
                         goto value_error;
@@ -127,6 +212,46 @@ static mp_obj_t mod_radio_config(size_t n_args, const mp_obj_t *pos_args, mp_map
                     new_config.prefix0 = value;
                     break;
 
+                case MP_QSTR_node:
+                    if (!(0 <= value && value <= 255)) {
+                        goto value_error;
+                    }
+                    new_config.node = value;
+                    new_config.node_set = true;
+                    break;
+
+                case MP_QSTR_retries:
+                    if (!(0 <= value && value <= 15)) {
+                        goto value_error;
+                    }
+                    new_config.retries = value;
+                    break;
+
+                case MP_QSTR_dwell:
+                    if (!(1 <= value && value <= 65535)) {
+                        goto value_error;
+                    }
+                    new_config.dwell_ms = value;
+                    break;
+
+                case MP_QSTR_listen_interval:
+                    if (!(0 <= value && value <= 65535)) {
+                        goto value_error;
+                    }
+                    new_config.listen_interval = value;
+                    break;
+
+                case MP_QSTR_listen_window:
+                    if (!(1 <= value && value <= 65535)) {
+                        goto value_error;
+                    }
+                    new_config.listen_window = value;
+                    break;
+
+                case MP_QSTR_relay:
+                    new_config.relay = value != 0;
+                    break;
+
                 default:
                     nlr_raise(mp_obj_new_exception_msg_varg(&mp_type_ValueError, MP_ERROR_TEXT("unknown argument '%q'"), arg_name));
                     break;
@@ -134,6 +259,27 @@ static mp_obj_t mod_radio_config(size_t n_args, const mp_obj_t *pos_args, mp_map
         }
     }
 
+    // duty cycling needs a listen window, which must fit in the listen interval
+    if (new_config.listen_interval != 0) {
+        if (new_config.listen_window == 0) {
+            mp_raise_ValueError(MP_ERROR_TEXT("listen_interval requires listen_window to be set"));
+        }
+        if (new_config.listen_window >= new_config.listen_interval) {
+            mp_raise_ValueError(MP_ERROR_TEXT("listen_window must be less than listen_interval"));
+        }
+    }
+
+    // the capture ring must still hold a record of the longest packet
+    size_t capture_size = microbit_radio_capture_size();
+    if (capture_size != 0 && capture_size < MICROBIT_RADIO_CAPTURE_HEADER_LEN + new_config.max_payload) {
+        mp_raise_ValueError(MP_ERROR_TEXT("length too big for capture size"));
+    }
+
+    // relaying needs a node id to recognise this device's own packets
+    if (new_config.relay && !new_config.node_set) {
+        mp_raise_ValueError(MP_ERROR_TEXT("relay requires node to be set"));
+    }
+
     // reconfigure the radio with the new state
 
     if (MP_STATE_PORT(radio_buf) == NULL) {
@@ -141,9 +287,11 @@ static mp_obj_t mod_radio_config(size_t n_args, const mp_obj_t *pos_args, mp_map
         radio_config = new_config;
     } else {
         // radio eabled
-        if (new_config.max_payload != radio_config.max_payload || new_config.queue_len != radio_config.queue_len) {
-            // tx/rx buffer size changed which requires reallocating the buffers
-            microbit_radio_disable();
+        if (new_config.max_payload != radio_config.max_payload
+            || new_config.queue_len != radio_config.queue_len
+            || new_config.tx_queue_len != radio_config.tx_queue_len) {
+            // tx/rx buffer size changed which requires reallocating the buffers,
+            // this keeps any RX callback and capture mode
             radio_config = new_config;
             microbit_radio_enable(&radio_config);
         } else {
@@ -172,14 +320,24 @@ static mp_obj_t mod_radio_off(void) {
 }
 MP_DEFINE_CONST_FUN_OBJ_0(mod_radio_off_obj, mod_radio_off);
 
-static mp_obj_t mod_radio_send_bytes(mp_obj_t buf_in) {
+static const mp_arg_t send_allowed_args[] = {
+    { MP_QSTR_message, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+    { MP_QSTR_wait, MP_ARG_BOOL, {.u_bool = true} },
+};
+
+static mp_obj_t mod_radio_send_bytes(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    mp_arg_val_t args[MP_ARRAY_SIZE(send_allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(send_allowed_args), send_allowed_args, args);
     mp_buffer_info_t bufinfo;
-    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_READ);
+    mp_get_buffer_raise(args[0].u_obj, &bufinfo, MP_BUFFER_READ);
     ensure_enabled();
     microbit_radio_send(bufinfo.buf, bufinfo.len, NULL, 0);
+    if (args[1].u_bool) {
+        microbit_radio_tx_wait();
+    }
     return mp_const_none;
 }
-MP_DEFINE_CONST_FUN_OBJ_1(mod_radio_send_bytes_obj, mod_radio_send_bytes);
+MP_DEFINE_CONST_FUN_OBJ_KW(mod_radio_send_bytes_obj, 1, mod_radio_send_bytes);
 
 static mp_obj_t mod_radio_receive_bytes(void) {
     ensure_enabled();
@@ -194,14 +352,235 @@ static mp_obj_t mod_radio_receive_bytes(void) {
 }
 MP_DEFINE_CONST_FUN_OBJ_0(mod_radio_receive_bytes_obj, mod_radio_receive_bytes);
 
-static mp_obj_t mod_radio_send(mp_obj_t buf_in) {
+static mp_obj_t mod_radio_send(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    mp_arg_val_t args[MP_ARRAY_SIZE(send_allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(send_allowed_args), send_allowed_args, args);
     mp_uint_t len;
-    const char *data = mp_obj_str_get_data(buf_in, &len);
+    const char *data = mp_obj_str_get_data(args[0].u_obj, &len);
     ensure_enabled();
     microbit_radio_send("\x01\x00\x01", 3, data, len);
+    if (args[1].u_bool) {
+        microbit_radio_tx_wait();
+    }
     return mp_const_none;
 }
-MP_DEFINE_CONST_FUN_OBJ_1(mod_radio_send_obj, mod_radio_send);
+MP_DEFINE_CONST_FUN_OBJ_KW(mod_radio_send_obj, 1, mod_radio_send);
+
+static mp_obj_t mod_radio_send_reliable(mp_obj_t buf_in, mp_obj_t node_in) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_READ);
+    mp_int_t node = mp_obj_get_int(node_in);
+    if (!(0 <= node && node <= 255)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("invalid node"));
+    }
+    if (radio_config.max_payload < MICROBIT_RADIO_RELIABLE_HEADER_LEN) {
+        mp_raise_ValueError(MP_ERROR_TEXT("length too small"));
+    }
+    ensure_enabled();
+    ensure_node();
+    return mp_obj_new_bool(microbit_radio_send_reliable(bufinfo.buf, bufinfo.len, node));
+}
+MP_DEFINE_CONST_FUN_OBJ_2(mod_radio_send_reliable_obj, mod_radio_send_reliable);
+
+static mp_obj_t mod_radio_send_large(mp_obj_t buf_in, mp_obj_t node_in) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_READ);
+    if (bufinfo.len > MICROBIT_RADIO_LARGE_MAX_LEN) {
+        mp_raise_ValueError(MP_ERROR_TEXT("message too long"));
+    }
+    mp_int_t node = mp_obj_get_int(node_in);
+    if (!(0 <= node && node <= 255)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("invalid node"));
+    }
+    if (radio_config.max_payload <= MICROBIT_RADIO_LARGE_HEADER_LEN) {
+        mp_raise_ValueError(MP_ERROR_TEXT("length too small"));
+    }
+    ensure_enabled();
+    ensure_node();
+    return mp_obj_new_bool(microbit_radio_send_large(bufinfo.buf, bufinfo.len, node));
+}
+MP_DEFINE_CONST_FUN_OBJ_2(mod_radio_send_large_obj, mod_radio_send_large);
+
+static mp_obj_t mod_radio_send_burst(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_message, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_duration, MP_ARG_OBJ, {.u_obj = mp_const_none} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0].u_obj, &bufinfo, MP_BUFFER_READ);
+    // by default cover one listen interval of a receiver configured like this device
+    mp_int_t duration_ms = radio_config.listen_interval;
+    if (args[1].u_obj != mp_const_none) {
+        duration_ms = mp_obj_get_int(args[1].u_obj);
+        if (duration_ms < 0) {
+            mp_raise_ValueError(MP_ERROR_TEXT("invalid duration"));
+        }
+    }
+    if (radio_config.max_payload < MICROBIT_RADIO_BURST_HEADER_LEN) {
+        mp_raise_ValueError(MP_ERROR_TEXT("length too small"));
+    }
+    ensure_enabled();
+    ensure_node();
+    microbit_radio_send_burst(bufinfo.buf, bufinfo.len, duration_ms);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(mod_radio_send_burst_obj, 1, mod_radio_send_burst);
+
+static mp_obj_t mod_radio_send_relay(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_message, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_ttl, MP_ARG_INT, {.u_int = MICROBIT_RADIO_DEFAULT_TTL} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0].u_obj, &bufinfo, MP_BUFFER_READ);
+    mp_int_t ttl = args[1].u_int;
+    if (!(1 <= ttl && ttl <= 255)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("invalid ttl"));
+    }
+    if (radio_config.max_payload < MICROBIT_RADIO_RELAY_HEADER_LEN) {
+        mp_raise_ValueError(MP_ERROR_TEXT("length too small"));
+    }
+    ensure_enabled();
+    ensure_node();
+    microbit_radio_send_relay(bufinfo.buf, bufinfo.len, ttl);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(mod_radio_send_relay_obj, 1, mod_radio_send_relay);
+
+static mp_obj_t mod_radio_send_many(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_messages, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_wait, MP_ARG_BOOL, {.u_bool = true} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    ensure_enabled();
+
+    // Queue the packets back to back so the radio IRQ sends them as a single burst,
+    // keeping the transmitter enabled between them.
+    mp_obj_t iter = mp_getiter(args[0].u_obj, NULL);
+    mp_obj_t item;
+    while ((item = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(item, &bufinfo, MP_BUFFER_READ);
+        microbit_radio_send(bufinfo.buf, bufinfo.len, NULL, 0);
+    }
+
+    if (args[1].u_bool) {
+        microbit_radio_tx_wait();
+    }
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(mod_radio_send_many_obj, 1, mod_radio_send_many);
+
+static mp_obj_t mod_radio_peek_group(void) {
+    ensure_enabled();
+    const uint8_t *buf = microbit_radio_peek();
+    if (buf == NULL) {
+        return mp_const_none;
+    } else {
+        return MP_OBJ_NEW_SMALL_INT(MICROBIT_RADIO_PACKET_GROUP(buf, buf[0]));
+    }
+}
+MP_DEFINE_CONST_FUN_OBJ_0(mod_radio_peek_group_obj, mod_radio_peek_group);
+
+static mp_obj_t mod_radio_peek_channel(void) {
+    ensure_enabled();
+    const uint8_t *buf = microbit_radio_peek();
+    if (buf == NULL) {
+        return mp_const_none;
+    } else {
+        return MP_OBJ_NEW_SMALL_INT(MICROBIT_RADIO_PACKET_CHANNEL(buf, buf[0]));
+    }
+}
+MP_DEFINE_CONST_FUN_OBJ_0(mod_radio_peek_channel_obj, mod_radio_peek_channel);
+
+static mp_obj_t mod_radio_on_receive(mp_obj_t callback) {
+    ensure_enabled();
+    if (callback == mp_const_none) {
+        callback = MP_OBJ_NULL;
+    } else if (!mp_obj_is_callable(callback)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("callback must be callable"));
+    }
+    microbit_radio_set_rx_callback(callback);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_1(mod_radio_on_receive_obj, mod_radio_on_receive);
+
+static void radio_stats_store(mp_obj_t dict, qstr key, mp_obj_t value) {
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(key), value);
+}
+
+// Returns the driver statistics as a dict keyed by name, so that code reading them
+// doesn't depend on their order and keeps working as counters are added.
+static mp_obj_t mod_radio_stats(void) {
+    ensure_enabled();
+    microbit_radio_stats_t stats;
+    microbit_radio_get_stats(&stats);
+    mp_obj_t dict = mp_obj_new_dict(22);
+    radio_stats_store(dict, MP_QSTR_rx_packets, mp_obj_new_int_from_uint(stats.rx_packets));
+    radio_stats_store(dict, MP_QSTR_rx_crc_errors, mp_obj_new_int_from_uint(stats.rx_crc_errors));
+    radio_stats_store(dict, MP_QSTR_rx_dropped, mp_obj_new_int_from_uint(stats.rx_dropped));
+    radio_stats_store(dict, MP_QSTR_rx_truncated, mp_obj_new_int_from_uint(stats.rx_truncated));
+    radio_stats_store(dict, MP_QSTR_rx_duplicates, mp_obj_new_int_from_uint(stats.rx_duplicates));
+    radio_stats_store(dict, MP_QSTR_tx_packets, mp_obj_new_int_from_uint(stats.tx_packets));
+    radio_stats_store(dict, MP_QSTR_tx_reliable_ok, mp_obj_new_int_from_uint(stats.tx_reliable_ok));
+    radio_stats_store(dict, MP_QSTR_tx_reliable_failed, mp_obj_new_int_from_uint(stats.tx_reliable_failed));
+    radio_stats_store(dict, MP_QSTR_tx_retries, mp_obj_new_int_from_uint(stats.tx_retries));
+    radio_stats_store(dict, MP_QSTR_ack_latency_us_total, mp_obj_new_int_from_uint(stats.ack_latency_us_total));
+    radio_stats_store(dict, MP_QSTR_ack_latency_us_max, mp_obj_new_int_from_uint(stats.ack_latency_us_max));
+    radio_stats_store(dict, MP_QSTR_relay_forwarded, mp_obj_new_int_from_uint(stats.relay_forwarded));
+    radio_stats_store(dict, MP_QSTR_relay_duplicates, mp_obj_new_int_from_uint(stats.relay_duplicates));
+    radio_stats_store(dict, MP_QSTR_relay_expired, mp_obj_new_int_from_uint(stats.relay_expired));
+    radio_stats_store(dict, MP_QSTR_relay_dropped, mp_obj_new_int_from_uint(stats.relay_dropped));
+    radio_stats_store(dict, MP_QSTR_capture_packets, mp_obj_new_int_from_uint(stats.capture_packets));
+    radio_stats_store(dict, MP_QSTR_capture_dropped, mp_obj_new_int_from_uint(stats.capture_dropped));
+    radio_stats_store(dict, MP_QSTR_rx_on_us, mp_obj_new_int_from_ull(stats.rx_on_us));
+    radio_stats_store(dict, MP_QSTR_tx_on_us, mp_obj_new_int_from_ull(stats.tx_on_us));
+    radio_stats_store(dict, MP_QSTR_off_us, mp_obj_new_int_from_ull(stats.off_us));
+    radio_stats_store(dict, MP_QSTR_isr_cycles_total, mp_obj_new_int_from_ull(stats.isr_cycles_total));
+    radio_stats_store(dict, MP_QSTR_isr_cycles_max, mp_obj_new_int_from_uint(stats.isr_cycles_max));
+    return dict;
+}
+MP_DEFINE_CONST_FUN_OBJ_0(mod_radio_stats_obj, mod_radio_stats);
+
+static mp_obj_t mod_radio_capture_start(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_size, MP_ARG_INT, {.u_int = 1024} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    mp_int_t size = args[0].u_int;
+    if (size < MICROBIT_RADIO_CAPTURE_HEADER_LEN + radio_config.max_payload) {
+        mp_raise_ValueError(MP_ERROR_TEXT("size too small"));
+    }
+    ensure_enabled();
+    microbit_radio_capture_start(size);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(mod_radio_capture_start_obj, 0, mod_radio_capture_start);
+
+static mp_obj_t mod_radio_capture_stop(void) {
+    microbit_radio_capture_stop();
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_0(mod_radio_capture_stop_obj, mod_radio_capture_stop);
+
+static mp_obj_t mod_radio_capture_drain(mp_obj_t stream_in) {
+    mp_get_stream_raise(stream_in, MP_STREAM_OP_WRITE);
+    return MP_OBJ_NEW_SMALL_INT(microbit_radio_capture_drain(stream_in));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(mod_radio_capture_drain_obj, mod_radio_capture_drain);
+
+static mp_obj_t mod_radio_tx_pending(void) {
+    ensure_enabled();
+    return MP_OBJ_NEW_SMALL_INT(microbit_radio_tx_pending());
+}
+MP_DEFINE_CONST_FUN_OBJ_0(mod_radio_tx_pending_obj, mod_radio_tx_pending);
 
 static mp_obj_t mod_radio_receive(void) {
     ensure_enabled();
@@ -237,6 +616,52 @@ static mp_obj_t mod_radio_receive_bytes_into(mp_obj_t buf_in) {
 }
 MP_DEFINE_CONST_FUN_OBJ_1(mod_radio_receive_bytes_into_obj, mod_radio_receive_bytes_into);
 
+static mp_obj_t mod_radio_receive_large_into(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_buffer, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_timeout, MP_ARG_OBJ, {.u_obj = mp_const_none} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0].u_obj, &bufinfo, MP_BUFFER_WRITE);
+    mp_int_t timeout_ms = -1;
+    if (args[1].u_obj != mp_const_none) {
+        timeout_ms = mp_obj_get_int(args[1].u_obj);
+    }
+    ensure_enabled();
+    ensure_node();
+
+    // The driver writes fragments directly into the buffer until the transfer is
+    // complete.  The buffer is referenced from this stack frame so it can't be
+    // collected while the driver is using it.
+    microbit_radio_receive_large_start(bufinfo.buf, bufinfo.len);
+    int len;
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        uint32_t start_ms = mp_hal_ticks_ms();
+        while ((len = microbit_radio_receive_large_poll()) < 0) {
+            if (timeout_ms >= 0 && mp_hal_ticks_ms() - start_ms >= (uint32_t)timeout_ms) {
+                break;
+            }
+            mp_handle_pending(true);
+            microbit_hal_idle();
+        }
+        nlr_pop();
+    } else {
+        // Catch all exceptions and stop receiving before re-raising.
+        microbit_radio_receive_large_stop();
+        nlr_jump(nlr.ret_val);
+    }
+    microbit_radio_receive_large_stop();
+
+    if (len < 0) {
+        return mp_const_none;
+    }
+    return MP_OBJ_NEW_SMALL_INT(len);
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(mod_radio_receive_large_into_obj, 1, mod_radio_receive_large_into);
+
 static mp_obj_t mod_radio_receive_full(void) {
     ensure_enabled();
     const uint8_t *buf = microbit_radio_peek();
@@ -274,6 +699,20 @@ static const mp_map_elem_t radio_module_globals_table[] = {
     { MP_OBJ_NEW_QSTR(MP_QSTR_receive), (mp_obj_t)&mod_radio_receive_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_receive_bytes_into), (mp_obj_t)&mod_radio_receive_bytes_into_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_receive_full), (mp_obj_t)&mod_radio_receive_full_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_send_reliable), (mp_obj_t)&mod_radio_send_reliable_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_send_many), (mp_obj_t)&mod_radio_send_many_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_send_large), (mp_obj_t)&mod_radio_send_large_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_send_relay), (mp_obj_t)&mod_radio_send_relay_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_send_burst), (mp_obj_t)&mod_radio_send_burst_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_receive_large_into), (mp_obj_t)&mod_radio_receive_large_into_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_peek_group), (mp_obj_t)&mod_radio_peek_group_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_peek_channel), (mp_obj_t)&mod_radio_peek_channel_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_tx_pending), (mp_obj_t)&mod_radio_tx_pending_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_on_receive), (mp_obj_t)&mod_radio_on_receive_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_stats), (mp_obj_t)&mod_radio_stats_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_capture_start), (mp_obj_t)&mod_radio_capture_start_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_capture_stop), (mp_obj_t)&mod_radio_capture_stop_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_capture_drain), (mp_obj_t)&mod_radio_capture_drain_obj },
 
     // A rate of 250Kbit is physically supported by the nRF52 but it is deprecated,
     // so don't provide the constant to the Python user.  They can still select this
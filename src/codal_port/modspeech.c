@@ -354,8 +354,8 @@ static const mp_obj_type_t speech_iterator_type = {
 static mp_obj_t make_speech_iter(void) {
     speech_iterator_t *result = m_new_obj(speech_iterator_t);
     result->base.type = &speech_iterator_type;
-    result->empty = microbit_audio_frame_make_new();
-    result->buf = microbit_audio_frame_make_new();
+    result->empty = microbit_audio_frame_make_new(AUDIO_CHUNK_SIZE);
+    result->buf = microbit_audio_frame_make_new(AUDIO_CHUNK_SIZE);
     return result;
 }
 
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+
+"""
+Convert a radio capture from MicroPython on the micro:bit to a pcap file.
+
+Usage: ./radiocapture2pcap.py <capture.bin> [-o <capture.pcap>]
+
+Output goes to stdout if no filename is given.
+
+The capture is the data written by radio.capture_drain(), either to a file on the
+micro:bit filesystem or to the UART.  It is a sequence of records, each an 8-byte
+header followed by the payload.  All integer values are unsigned and stored little
+endian.
+
+0x00  0x01   0x02  0x03     0x04  0x05  0x06  0x07
+
+LEN   FLAGS  RSSI  CHANNEL  TIME                    PAYLOAD (LEN bytes)
+
+The values are:
+
+LEN        - 1 byte  - length in bytes of the payload
+FLAGS      - 1 byte  - bit 0 set if the CRC of the packet was correct
+RSSI       - 1 byte  - received signal strength, negated, in dBm
+CHANNEL    - 1 byte  - channel the packet was received on (2400MHz + CHANNEL)
+TIME       - 4 bytes - microsecond timestamp of the start of the packet
+
+Each pcap record contains the whole capture record, header included, using the
+LINKTYPE_USER0 link type.  The 32-bit microsecond timestamps wrap around after
+about 71 minutes, and this is accounted for when converting them to pcap
+timestamps, which start from zero.
+"""
+
+import argparse
+import struct
+import sys
+
+PCAP_MAGIC = 0xA1B2C3D4
+PCAP_VERSION_MAJOR = 2
+PCAP_VERSION_MINOR = 4
+PCAP_SNAPLEN = 65535
+LINKTYPE_USER0 = 147
+
+CAPTURE_HEADER_LEN = 8
+CAPTURE_FLAG_CRC_OK = 0x01
+
+
+def parse_capture(data):
+    """Yield (flags, rssi_dbm, channel, time_us, payload) for each record."""
+    offset = 0
+    while offset + CAPTURE_HEADER_LEN <= len(data):
+        length, flags, rssi, channel, time_us = struct.unpack_from("<BBBBI", data, offset)
+        start = offset + CAPTURE_HEADER_LEN
+        if start + length > len(data):
+            print("warning: truncated record at offset {}".format(offset), file=sys.stderr)
+            return
+        yield flags, -rssi, channel, time_us, data[start : start + length]
+        offset = start + length
+    if offset != len(data):
+        print("warning: {} trailing bytes".format(len(data) - offset), file=sys.stderr)
+
+
+def write_pcap(records, out):
+    out.write(
+        struct.pack(
+            "<IHHiIII",
+            PCAP_MAGIC,
+            PCAP_VERSION_MAJOR,
+            PCAP_VERSION_MINOR,
+            0,
+            0,
+            PCAP_SNAPLEN,
+            LINKTYPE_USER0,
+        )
+    )
+    first_time = None
+    last_time = 0
+    wraps = 0
+    for flags, rssi_dbm, channel, time_us, payload in records:
+        if first_time is None:
+            first_time = time_us
+        elif time_us < last_time:
+            wraps += 1
+        last_time = time_us
+        t = (wraps << 32) + time_us - first_time
+        record = struct.pack("<BBBBI", len(payload), flags, -rssi_dbm, channel, time_us) + payload
+        out.write(struct.pack("<IIII", t // 1000000, t % 1000000, len(record), len(record)))
+        out.write(record)
+
+
+def main():
+    cmd_parser = argparse.ArgumentParser(description="Convert a micro:bit radio capture to pcap.")
+    cmd_parser.add_argument("-o", "--output", help="output file")
+    cmd_parser.add_argument("-v", "--verbose", action="store_true", help="print each packet")
+    cmd_parser.add_argument("capture", help="capture file from radio.capture_drain()")
+    args = cmd_parser.parse_args()
+
+    with open(args.capture, "rb") as f:
+        data = f.read()
+
+    records = list(parse_capture(data))
+    if args.verbose:
+        for flags, rssi_dbm, channel, time_us, payload in records:
+            print(
+                "{:10} ch={:3} rssi={:4} crc={} {}".format(
+                    time_us,
+                    channel,
+                    rssi_dbm,
+                    "ok " if flags & CAPTURE_FLAG_CRC_OK else "bad",
+                    payload.hex(),
+                ),
+                file=sys.stderr,
+            )
+
+    if args.output:
+        with open(args.output, "wb") as f:
+            write_pcap(records, f)
+    else:
+        write_pcap(records, sys.stdout.buffer)
+
+
+if __name__ == "__main__":
+    main()
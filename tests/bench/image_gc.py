@@ -0,0 +1,80 @@
+# Measure how much a steady-state display animation allocates, with and without
+# the out= and _into variants of the Image operations.
+#
+# Copy this to the micro:bit as main.py (or run it from the REPL) and watch the
+# serial output.  Each loop computes FRAMES frames of an animation, once with the
+# allocating operations and once writing into buffers made before the loop.  The
+# garbage collector is disabled while a loop runs, so the growth of gc.mem_alloc()
+# is everything the loop allocated, and every byte of it is work for a later
+# collection.  The buffered loops should allocate nothing.
+
+import gc
+from microbit import Image
+from time import ticks_us, ticks_diff
+
+FRAMES = 200
+SPRITE = Image("09090:99999:99999:09990:00900")
+BACKGROUND = Image("10001:01010:00100:01010:10001")
+
+
+# buffers for the loops that don't allocate, made before they are measured
+sprite_buf = Image(5, 5)
+frame_buf = Image(5, 5)
+
+
+def shift_alloc(n):
+    frame = SPRITE
+    for _ in range(n):
+        frame = frame.shift_left(1)
+
+
+def shift_out(n):
+    sprite_buf.blit(SPRITE, 0, 0, 5, 5)
+    for _ in range(n):
+        sprite_buf.shift_left(1, out=sprite_buf)
+
+
+def blend_alloc(n):
+    sprite = SPRITE
+    for _ in range(n):
+        frame = BACKGROUND + sprite
+        sprite = sprite.shift_left(1)
+
+
+def blend_into(n):
+    sprite_buf.blit(SPRITE, 0, 0, 5, 5)
+    for _ in range(n):
+        Image.blend_into(frame_buf, BACKGROUND, sprite_buf)
+        sprite_buf.shift_left(1, out=sprite_buf)
+
+
+def measure(loop):
+    # run once first so any one-off allocation, like interning, isn't counted
+    loop(1)
+    gc.collect()
+    gc.disable()
+    try:
+        before = gc.mem_alloc()
+        start = ticks_us()
+        loop(FRAMES)
+        us = ticks_diff(ticks_us(), start)
+        after = gc.mem_alloc()
+    finally:
+        gc.enable()
+    return after - before, us
+
+
+def main():
+    print("Image GC benchmark, {} frames per loop".format(FRAMES))
+    print("{:12} {:>8} {:>10} {:>10}".format("loop", "bytes", "bytes/frm", "us/frame"))
+    for name, loop in (
+        ("shift", shift_alloc),
+        ("shift out=", shift_out),
+        ("add", blend_alloc),
+        ("blend_into", blend_into),
+    ):
+        allocated, us = measure(loop)
+        print("{:12} {:8} {:10} {:10}".format(name, allocated, allocated // FRAMES, us // FRAMES))
+
+
+main()
@@ -0,0 +1,81 @@
+# Measure radio transmit throughput on the micro:bit, in packets per second.
+#
+# Copy this to the micro:bit as main.py (or run it from the REPL) and watch the
+# serial output.  No receiver is needed.  For each packet length and data rate it
+# sends the same number of packets three ways:
+#
+#  send_bytes  - one packet at a time, waiting for each to go out
+#  send_many   - all of them in one call, which the driver sends back to back
+#  tx_packets  - the same burst with wait=False, sampling radio.stats() while the
+#                driver drains the queue, to show the rate the radio sustains
+#
+# The rates come from the tx_packets counter of radio.stats(), so they count the
+# packets the radio actually finished sending.
+
+import radio
+from time import ticks_us, ticks_diff
+
+NUM_PACKETS = 200
+TX_QUEUE = 32
+LENGTHS = (8, 32, 64)
+RATES = (("1Mbit", radio.RATE_1MBIT), ("2Mbit", radio.RATE_2MBIT))
+
+
+def tx_packets():
+    return radio.stats()["tx_packets"]
+
+
+def rate(packets, us):
+    return packets * 1000000 // us if us > 0 else 0
+
+
+def bench_send_bytes(packet):
+    start_count = tx_packets()
+    start = ticks_us()
+    for _ in range(NUM_PACKETS):
+        radio.send_bytes(packet)
+    us = ticks_diff(ticks_us(), start)
+    return rate(tx_packets() - start_count, us)
+
+
+def bench_send_many(packets):
+    start_count = tx_packets()
+    start = ticks_us()
+    for i in range(0, NUM_PACKETS, TX_QUEUE):
+        radio.send_many(packets[: min(TX_QUEUE, NUM_PACKETS - i)])
+    us = ticks_diff(ticks_us(), start)
+    return rate(tx_packets() - start_count, us)
+
+
+def bench_sampled(packets):
+    # Queue a full TX queue without waiting, then time the packets from the first
+    # one seen to finish to the last, so the time to queue them isn't counted.
+    radio.send_many(packets, wait=False)
+    count = tx_packets()
+    while tx_packets() == count:
+        pass
+    first = tx_packets()
+    start = ticks_us()
+    while radio.tx_pending():
+        pass
+    us = ticks_diff(ticks_us(), start)
+    return rate(tx_packets() - first, us)
+
+
+def main():
+    print("radio send_many benchmark, {} packets per run".format(NUM_PACKETS))
+    print("rate   len  send_bytes  send_many  tx_packets  (packets/s)")
+    for rate_name, data_rate in RATES:
+        for length in LENGTHS:
+            radio.config(length=length, tx_queue=TX_QUEUE, data_rate=data_rate)
+            radio.on()
+            packet = bytes(range(length))
+            packets = [packet] * TX_QUEUE
+            one = bench_send_bytes(packet)
+            many = bench_send_many(packets)
+            sampled = bench_sampled(packets)
+            radio.off()
+            print("{:6} {:4} {:10} {:10} {:11}".format(rate_name, length, one, many, sampled))
+
+
+main()
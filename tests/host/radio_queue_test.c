@@ -0,0 +1,194 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Flood stress test of the radio RX/TX ring, built and run on the host.
+//
+// A producer thread plays the part of the radio IRQ: it fills slots with a
+// sequence number as fast as it can, and counts a drop whenever the ring is full
+// (on the device the packet is then received into the spare buffer and lost).  The
+// main thread is the consumer, like peek/pop, and stalls now and then so the ring
+// fills up.  Afterwards every packet must have been either received, in order and
+// intact, or counted as dropped.
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define __DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#include "drv_radio_queue.h"
+
+#define SLOT_SIZE (32)
+#define NUM_PACKETS (1000000)
+
+typedef struct _flood_t {
+    radio_queue_t q;
+    volatile int done;
+    uint32_t dropped;
+} flood_t;
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            ++failures; \
+            return; \
+        } \
+} while (0)
+
+static void *producer(void *arg) {
+    flood_t *f = arg;
+    uint32_t gap = 1;
+    for (uint32_t seq = 0; seq < NUM_PACKETS; ++seq) {
+        // vary the time between packets, like air time and inter-packet gaps do
+        gap = gap * 1103515245 + 12345;
+        for (volatile uint32_t i = (gap >> 16) % 200; i; --i) {
+        }
+        if ((gap >> 16) % 4 == 0) {
+            // let the consumer run even on a single core
+            sched_yield();
+        }
+        if (radio_queue_is_full(&f->q)) {
+            ++f->dropped;
+            continue;
+        }
+        // fill the whole slot, so the consumer can see a torn or stale slot
+        uint8_t *slot = radio_queue_slot(&f->q, f->q.head);
+        memcpy(slot, &seq, sizeof(seq));
+        memset(slot + sizeof(seq), seq & 0xff, SLOT_SIZE - sizeof(seq));
+        radio_queue_push(&f->q);
+    }
+    f->done = 1;
+    return NULL;
+}
+
+static void test_flood(uint16_t len) {
+    flood_t f = { .done = 0, .dropped = 0 };
+    uint8_t *buf = malloc(len * SLOT_SIZE);
+    radio_queue_init(&f.q, buf, SLOT_SIZE, len);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer, &f);
+
+    uint32_t received = 0;
+    uint32_t missing = 0; // gaps in the received sequence numbers
+    uint32_t expected = 0;
+    uint32_t stall = 1;
+    for (;;) {
+        // read done before the count, so the last packets aren't missed
+        int done = f.done;
+        __DMB();
+        size_t count = radio_queue_count(&f.q);
+        CHECK(count <= len, "len %u: count %zu", len, count);
+        if (count == 0) {
+            if (done) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+        const uint8_t *slot = radio_queue_slot(&f.q, f.q.tail);
+        uint32_t seq;
+        memcpy(&seq, slot, sizeof(seq));
+        CHECK(seq >= expected, "len %u: got packet %u after %u", len, seq, expected - 1);
+        for (size_t i = sizeof(seq); i < SLOT_SIZE; ++i) {
+            CHECK(slot[i] == (seq & 0xff), "len %u: packet %u corrupt at byte %zu", len, seq, i);
+        }
+        missing += seq - expected;
+        expected = seq + 1;
+        ++received;
+        radio_queue_pop(&f.q);
+
+        // stall every so often, for a varying time, to let the producer fill the ring
+        stall = stall * 1103515245 + 12345;
+        if ((stall >> 16) % 64 == 0) {
+            for (uint32_t i = (stall >> 8) % 64; i; --i) {
+                sched_yield();
+            }
+        }
+    }
+    pthread_join(thread, NULL);
+    missing += NUM_PACKETS - expected;
+
+    CHECK(received + f.dropped == NUM_PACKETS, "len %u: received %u + dropped %u != %u",
+        len, received, f.dropped, NUM_PACKETS);
+    CHECK(missing == f.dropped, "len %u: %u packets missing but %u dropped", len, missing, f.dropped);
+    CHECK(f.q.head == f.q.tail, "len %u: ring not empty", len);
+    printf("len %5u: received %7u dropped %7u\n", len, received, f.dropped);
+    free(buf);
+}
+
+// Walk the indices of a single-threaded ring through several wraps at 2 * len,
+// checking the count and slot addresses at every fill level.
+static void test_wrap(uint16_t len) {
+    uint8_t *buf = malloc(len * SLOT_SIZE);
+    radio_queue_t q;
+    radio_queue_init(&q, buf, SLOT_SIZE, len);
+    for (uint32_t round = 0; round < 4 * len + 3; ++round) {
+        for (size_t n = 0; n < len; ++n) {
+            CHECK(radio_queue_count(&q) == n, "len %u: count %zu, expected %zu", len, radio_queue_count(&q), n);
+            CHECK(!radio_queue_is_full(&q), "len %u: full with %zu", len, n);
+            uint8_t *slot = radio_queue_slot(&q, q.head);
+            CHECK(slot >= buf && slot < buf + len * SLOT_SIZE && (slot - buf) % SLOT_SIZE == 0,
+                "len %u: bad slot for head %u", len, q.head);
+            *slot = round + n;
+            radio_queue_push(&q);
+            CHECK(q.head < 2 * len, "len %u: head %u out of range", len, q.head);
+        }
+        CHECK(radio_queue_is_full(&q), "len %u: not full", len);
+        for (size_t n = 0; n < len; ++n) {
+            CHECK(*radio_queue_slot(&q, q.tail) == (uint8_t)(round + n), "len %u: out of order", len);
+            radio_queue_pop(&q);
+            CHECK(q.tail < 2 * len, "len %u: tail %u out of range", len, q.tail);
+        }
+        CHECK(radio_queue_count(&q) == 0, "len %u: not empty", len);
+        // offset the next round by one slot, so every start position is covered
+        radio_queue_push(&q);
+        radio_queue_pop(&q);
+    }
+    free(buf);
+}
+
+int main(void) {
+    static const uint16_t lens[] = { 1, 2, 3, 4, 7, 16, 255, 1000 };
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); ++i) {
+        test_wrap(lens[i]);
+    }
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); ++i) {
+        test_flood(lens[i]);
+    }
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
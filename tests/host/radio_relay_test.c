@@ -0,0 +1,169 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Tests of the relay protocol of drv_radio.c on the simulated medium.  The nodes are
+// in a line, 0 - 1 - 2, so node 2 only hears node 0's packets through node 1.  Node
+// 3 hears only node 1 and has no node id, so it receives the relayed packets raw,
+// with their header, and can see the TTL they were forwarded with.
+
+#include <stdio.h>
+
+#include "py/runtime.h"
+#include "drv_radio.h"
+#include "radiosim.h"
+
+#define CHECK(cond, ...) do { \
+        if (!(cond)) { \
+            printf("node %d: FAIL %s:%d: ", radiosim_node_index(), __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            return 1; \
+        } \
+} while (0)
+
+#define NUM_FORWARDED (20) // sent with a TTL of 3, so relayed by nodes 1 and 2
+#define NUM_EXPIRED (10) // sent with a TTL of 1, so not relayed at all
+#define RELAY_TTL (3)
+#define SNIFFER (3)
+
+// Receive packets until none has arrived for 50ms, checking that each is the next
+// one node 0 sent, and return how many there were.  The sniffer's packets still
+// have their relay header: 1, 0, protocol, seq, src, TTL.
+static int receive_relayed(int expected_ttl) {
+    int received = 0;
+    uint32_t start = radiosim_now_us();
+    while (radiosim_now_us() - start < 50000) {
+        const uint8_t *pkt = microbit_radio_peek();
+        if (pkt == NULL) {
+            radiosim_sleep_us(200);
+            continue;
+        }
+        const uint8_t *p = MICROBIT_RADIO_PACKET_PAYLOAD(pkt);
+        size_t len = MICROBIT_RADIO_PACKET_LEN(pkt);
+        if (expected_ttl != 0) {
+            if (len != MICROBIT_RADIO_RELAY_HEADER_LEN + 2 || p[4] != 1 || p[5] != expected_ttl) {
+                printf("node %d: bad packet: len %zu src %d TTL %d\n", radiosim_node_index(), len, p[4], p[5]);
+                return -1;
+            }
+            p += MICROBIT_RADIO_RELAY_HEADER_LEN;
+            len -= MICROBIT_RADIO_RELAY_HEADER_LEN;
+        }
+        if (len != 2 || p[0] != received || p[1] != 0xc3) {
+            printf("node %d: got packet %d, expected %d\n", radiosim_node_index(), p[0], received);
+            return -1;
+        }
+        ++received;
+        start = radiosim_now_us();
+        microbit_radio_pop();
+    }
+    return received;
+}
+
+static int node_relay(int index) {
+    microbit_radio_config_t config;
+    radiosim_radio_config_default(&config);
+    config.queue_len = 64;
+    if (index != SNIFFER) {
+        config.node = index + 1;
+        config.node_set = true;
+        config.relay = true;
+    }
+    microbit_radio_enable(&config);
+    radiosim_barrier();
+
+    int received = 0;
+    if (index == 0) {
+        // leave time between the packets for them to be relayed, so that the relay
+        // buffers are free and the packets don't collide
+        for (int i = 0; i < NUM_FORWARDED + NUM_EXPIRED; ++i) {
+            uint8_t buf[2] = { i, 0xc3 };
+            microbit_radio_send_relay(buf, sizeof(buf), i < NUM_FORWARDED ? RELAY_TTL : 1);
+            radiosim_sleep_us(5000);
+        }
+        radiosim_sleep_us(50000);
+    } else {
+        received = receive_relayed(index == SNIFFER ? RELAY_TTL - 1 : 0);
+    }
+    radiosim_barrier();
+
+    microbit_radio_stats_t stats;
+    microbit_radio_get_stats(&stats);
+    printf("node %d: received %d, forwarded %u, duplicates %u, expired %u, dropped %u\n",
+        index, received, (unsigned)stats.relay_forwarded, (unsigned)stats.relay_duplicates,
+        (unsigned)stats.relay_expired, (unsigned)stats.relay_dropped);
+    CHECK(stats.relay_dropped == 0, "relay buffer was busy");
+    switch (index) {
+        case 0:
+            // hears its own packets when node 1 relays them
+            CHECK(stats.relay_forwarded == 0 && stats.relay_expired == 0, "relayed its own packets");
+            CHECK(stats.relay_duplicates == NUM_FORWARDED, "didn't drop its own packets");
+            break;
+        case 1:
+            CHECK(received == NUM_FORWARDED + NUM_EXPIRED, "received %d", received);
+            CHECK(stats.relay_forwarded == NUM_FORWARDED, "forwarded %u", (unsigned)stats.relay_forwarded);
+            CHECK(stats.relay_expired == NUM_EXPIRED, "expired %u", (unsigned)stats.relay_expired);
+            // node 2 relays each packet back, and the duplicate cache stops it going
+            // round again
+            CHECK(stats.relay_duplicates == NUM_FORWARDED, "duplicates %u", (unsigned)stats.relay_duplicates);
+            break;
+        case 2:
+            // relayed with a TTL of 2, so forwarded once more with a TTL of 1
+            CHECK(received == NUM_FORWARDED, "received %d", received);
+            CHECK(stats.relay_forwarded == NUM_FORWARDED, "forwarded %u", (unsigned)stats.relay_forwarded);
+            CHECK(stats.relay_duplicates == 0 && stats.relay_expired == 0, "unexpected drops");
+            break;
+        case SNIFFER:
+            // node 1's copies of the packets, with the TTL decremented
+            CHECK(received == NUM_FORWARDED, "received %d", received);
+            break;
+    }
+    radiosim_barrier();
+    microbit_radio_disable();
+    return 0;
+}
+
+int main(void) {
+    radiosim_config_t config;
+    radiosim_config_init(&config, 4);
+    // the medium runs at a fifth of real time so no node misses packets while the
+    // host isn't running it
+    config.time_scale = MAX(config.time_scale, 5);
+    for (int a = 0; a < 4; ++a) {
+        for (int b = 0; b < 4; ++b) {
+            config.links[a][b] = 0;
+        }
+    }
+    radiosim_config_link(&config, 0, 1, -50);
+    radiosim_config_link(&config, 1, 2, -50);
+    radiosim_config_link(&config, 1, SNIFFER, -50);
+    int ret = radiosim_run(&config, node_relay);
+    printf("relay: %s\n", ret ? "FAIL" : "ok");
+    if (ret) {
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
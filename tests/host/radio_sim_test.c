@@ -0,0 +1,259 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Tests of drv_radio.c on the simulated medium, one process per node.  Each test
+// checks what the receivers saw against the medium's knobs: which nodes hear each
+// other and at what RSSI, the loss rate and the latency.
+
+#include <stdio.h>
+
+#include "py/runtime.h"
+#include "drv_radio.h"
+#include "radiosim.h"
+
+#define CHECK(cond, ...) do { \
+        if (!(cond)) { \
+            printf("node %d: FAIL %s:%d: ", radiosim_node_index(), __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            return 1; \
+        } \
+} while (0)
+
+static uint32_t packet_time_us(const uint8_t *pkt) {
+    size_t len = MICROBIT_RADIO_PACKET_LEN(pkt);
+    return pkt[1 + len + 1] | pkt[1 + len + 2] << 8 | pkt[1 + len + 3] << 16 | (uint32_t)pkt[1 + len + 4] << 24;
+}
+
+static void enable(uint8_t channel) {
+    microbit_radio_config_t config;
+    radiosim_radio_config_default(&config);
+    config.queue_len = 32;
+    config.channel = channel;
+    microbit_radio_enable(&config);
+}
+
+// Send count packets, each holding its index and the time it was queued.
+static void send_numbered(int count, uint32_t gap_us) {
+    for (int i = 0; i < count; ++i) {
+        uint32_t now = radiosim_now_us();
+        uint8_t buf[8] = { i, i >> 8, now, now >> 8, now >> 16, now >> 24, radiosim_node_index(), 0xa5 };
+        microbit_radio_send(buf, sizeof(buf), NULL, 0);
+        microbit_radio_tx_wait();
+        radiosim_sleep_us(gap_us);
+    }
+}
+
+// Receive numbered packets until count have arrived or none has for timeout_us,
+// checking them as they come, and return how many arrived.  No packet can arrive
+// sooner than min_delay_us after it was sent.  The host may deschedule a node for
+// a few milliseconds, so only most of them have to arrive within max_delay_us.
+static int receive_numbered(int count, uint32_t timeout_us, int8_t rssi, uint32_t min_delay_us, uint32_t max_delay_us) {
+    int received = 0;
+    int late = 0;
+    int last = -1;
+    uint32_t start = radiosim_now_us();
+    while (received < count && radiosim_now_us() - start < timeout_us) {
+        const uint8_t *pkt = microbit_radio_peek();
+        if (pkt == NULL) {
+            radiosim_sleep_us(200);
+            continue;
+        }
+        const uint8_t *p = MICROBIT_RADIO_PACKET_PAYLOAD(pkt);
+        size_t len = MICROBIT_RADIO_PACKET_LEN(pkt);
+        int idx = p[0] | p[1] << 8;
+        uint32_t sent = p[2] | p[3] << 8 | p[4] << 16 | (uint32_t)p[5] << 24;
+        uint32_t delay = packet_time_us(pkt) - sent;
+        if (len != 8 || p[7] != 0xa5 || idx <= last
+            || MICROBIT_RADIO_PACKET_RSSI(pkt, len) != rssi
+            || MICROBIT_RADIO_PACKET_CHANNEL(pkt, len) != MICROBIT_RADIO_DEFAULT_CHANNEL
+            || MICROBIT_RADIO_PACKET_ADDR(pkt, len) != 0
+            || delay < min_delay_us) {
+            printf("node %d: bad packet: len %zu idx %d after %d rssi %d delay %u\n",
+                radiosim_node_index(), len, idx, last, MICROBIT_RADIO_PACKET_RSSI(pkt, len), (unsigned)delay);
+            return -1;
+        }
+        late += delay > max_delay_us;
+        last = idx;
+        ++received;
+        start = radiosim_now_us();
+        microbit_radio_pop();
+    }
+    if (late > received / 10) {
+        printf("node %d: %d of %d packets took over %uus\n", radiosim_node_index(), late, received, (unsigned)max_delay_us);
+        return -1;
+    }
+    return received;
+}
+
+// Node 0 reaches node 1 at -40dBm and node 2 at -70dBm; nodes 1 and 2 can't hear
+// each other.  Every packet arrives, in order, with the link's RSSI.
+static int node_basic(int index) {
+    enable(MICROBIT_RADIO_DEFAULT_CHANNEL);
+    radiosim_barrier();
+    if (index == 0) {
+        send_numbered(50, 1000);
+        microbit_radio_stats_t stats;
+        microbit_radio_get_stats(&stats);
+        CHECK(stats.tx_packets == 50, "tx_packets %u", (unsigned)stats.tx_packets);
+    } else if (index == 1) {
+        int n = receive_numbered(50, 500000, -40, 0, 20000);
+        CHECK(n == 50, "received %d of 50", n);
+        send_numbered(1, 0);
+    } else {
+        int n = receive_numbered(51, 200000, -70, 0, 20000);
+        CHECK(n == 50, "received %d of 50, including one from node 1", n);
+    }
+    radiosim_barrier();
+    microbit_radio_disable();
+    return 0;
+}
+
+// With a loss of 0.3 about 70% of the packets arrive, and with a latency of 5ms
+// each arrives at least 5ms after it was sent.
+static int node_loss(int index) {
+    enable(MICROBIT_RADIO_DEFAULT_CHANNEL);
+    radiosim_barrier();
+    if (index == 0) {
+        send_numbered(400, 500);
+    } else {
+        int n = receive_numbered(400, 100000, -50, 5000, 10000);
+        CHECK(n >= 400 * 55 / 100 && n <= 400 * 85 / 100, "received %d of 400", n);
+    }
+    radiosim_barrier();
+    microbit_radio_disable();
+    return 0;
+}
+
+// A receiver on another channel hears nothing.
+static int node_channel(int index) {
+    enable(index == 0 ? MICROBIT_RADIO_DEFAULT_CHANNEL : MICROBIT_RADIO_DEFAULT_CHANNEL + 1);
+    radiosim_barrier();
+    if (index == 0) {
+        send_numbered(20, 1000);
+    } else {
+        int n = receive_numbered(20, 100000, -50, 0, 5000);
+        CHECK(n == 0, "received %d packets on the wrong channel", n);
+    }
+    radiosim_barrier();
+    microbit_radio_disable();
+    return 0;
+}
+
+// Reliable packets are all acknowledged on a clean link, and with loss they get
+// through by retransmission.
+static int node_reliable(int index) {
+    microbit_radio_config_t config;
+    radiosim_radio_config_default(&config);
+    config.queue_len = 32;
+    config.node = index + 1;
+    config.node_set = true;
+    config.retries = 15;
+    microbit_radio_enable(&config);
+    radiosim_barrier();
+    if (index == 0) {
+        int acked = 0;
+        for (int i = 0; i < 50; ++i) {
+            uint8_t buf[2] = { i, 0x5a };
+            acked += microbit_radio_send_reliable(buf, sizeof(buf), 2);
+        }
+        microbit_radio_stats_t stats;
+        microbit_radio_get_stats(&stats);
+        printf("reliable: %d of 50 acknowledged, %u retries\n", acked, (unsigned)stats.tx_retries);
+        CHECK(acked == 50, "%d of 50 acknowledged", acked);
+        CHECK(stats.tx_reliable_ok == 50, "tx_reliable_ok %u", (unsigned)stats.tx_reliable_ok);
+        CHECK(stats.tx_retries > 0, "no retries despite the loss");
+    } else {
+        int next = 0;
+        uint32_t start = radiosim_now_us();
+        while (next < 50 && radiosim_now_us() - start < 1000000) {
+            const uint8_t *pkt = microbit_radio_peek();
+            if (pkt == NULL) {
+                radiosim_sleep_us(200);
+                continue;
+            }
+            size_t len = MICROBIT_RADIO_PACKET_LEN(pkt);
+            const uint8_t *p = MICROBIT_RADIO_PACKET_PAYLOAD(pkt);
+            // duplicates are suppressed, so each packet is delivered exactly once
+            CHECK(len == 2 && p[0] == next && p[1] == 0x5a, "got packet %d, expected %d", p[0], next);
+            ++next;
+            start = radiosim_now_us();
+            microbit_radio_pop();
+        }
+        CHECK(next == 50, "received %d of 50", next);
+    }
+    radiosim_barrier();
+    microbit_radio_disable();
+    return 0;
+}
+
+// Run the medium at a fifth of real time or slower, so that a node the host
+// deschedules for a few milliseconds doesn't miss packets or stretch the latency.
+static void config_init(radiosim_config_t *config, int num_nodes) {
+    radiosim_config_init(config, num_nodes);
+    config->time_scale = MAX(config->time_scale, 5);
+}
+
+int main(void) {
+    int failures = 0;
+    radiosim_config_t config;
+
+    config_init(&config, 3);
+    radiosim_config_link(&config, 0, 1, -40);
+    radiosim_config_link(&config, 0, 2, -70);
+    radiosim_config_link(&config, 1, 2, 0);
+    failures += radiosim_run(&config, node_basic);
+    printf("basic: %s\n", failures ? "FAIL" : "ok");
+
+    config_init(&config, 2);
+    config.loss = 0.3;
+    config.latency_us = 5000;
+    int ret = radiosim_run(&config, node_loss);
+    printf("loss and latency: %s\n", ret ? "FAIL" : "ok");
+    failures += ret;
+
+    config_init(&config, 2);
+    ret = radiosim_run(&config, node_channel);
+    printf("channel: %s\n", ret ? "FAIL" : "ok");
+    failures += ret;
+
+    config_init(&config, 2);
+    config.loss = 0.2;
+    if (config.time_scale < 20) {
+        // the ACK timeout is under 1ms, so give the host time to schedule the nodes
+        config.time_scale = 20;
+    }
+    ret = radiosim_run(&config, node_reliable);
+    printf("reliable: %s\n", ret ? "FAIL" : "ok");
+    failures += ret;
+
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MICROPY_INCLUDED_RADIOSIM_NRF_H
+#define MICROPY_INCLUDED_RADIOSIM_NRF_H
+
+// Host stand-in for the parts of the nRF52833 MDK and CMSIS that drv_radio.c uses.
+// The peripherals live in a page that is mapped read-only for the firmware, so
+// that radiosim.c sees every register write, see radiosim.h.  Only the registers
+// the driver touches are modelled, and their layout differs from the hardware.
+
+#include <stdint.h>
+
+typedef enum {
+    RADIO_IRQn = 1,
+    TIMER4_IRQn = 39,
+} IRQn_Type;
+
+typedef struct {
+    volatile uint32_t TASKS_TXEN;
+    volatile uint32_t TASKS_RXEN;
+    volatile uint32_t TASKS_START;
+    volatile uint32_t TASKS_STOP;
+    volatile uint32_t TASKS_DISABLE;
+    volatile uint32_t TASKS_RSSISTART;
+    volatile uint32_t EVENTS_READY;
+    volatile uint32_t EVENTS_ADDRESS;
+    volatile uint32_t EVENTS_PAYLOAD;
+    volatile uint32_t EVENTS_END;
+    volatile uint32_t EVENTS_DISABLED;
+    volatile uint32_t SHORTS;
+    volatile uint32_t INTENSET;
+    volatile uint32_t INTENCLR;
+    volatile uint32_t CRCSTATUS;
+    volatile uint32_t RXMATCH;
+    volatile uint32_t PACKETPTR;
+    volatile uint32_t FREQUENCY;
+    volatile uint32_t TXPOWER;
+    volatile uint32_t MODE;
+    volatile uint32_t PCNF0;
+    volatile uint32_t PCNF1;
+    volatile uint32_t BASE0;
+    volatile uint32_t BASE1;
+    volatile uint32_t PREFIX0;
+    volatile uint32_t PREFIX1;
+    volatile uint32_t TXADDRESS;
+    volatile uint32_t RXADDRESSES;
+    volatile uint32_t CRCCNF;
+    volatile uint32_t CRCPOLY;
+    volatile uint32_t CRCINIT;
+    volatile uint32_t RSSISAMPLE;
+    volatile uint32_t STATE;
+    volatile uint32_t DATAWHITEIV;
+    volatile uint32_t MODECNF0;
+} NRF_RADIO_Type;
+
+typedef struct {
+    volatile uint32_t TASKS_START;
+    volatile uint32_t TASKS_STOP;
+    volatile uint32_t TASKS_CLEAR;
+    volatile uint32_t TASKS_CAPTURE[6];
+    volatile uint32_t EVENTS_COMPARE[6];
+    volatile uint32_t SHORTS;
+    volatile uint32_t INTENSET;
+    volatile uint32_t INTENCLR;
+    volatile uint32_t MODE;
+    volatile uint32_t BITMODE;
+    volatile uint32_t PRESCALER;
+    volatile uint32_t CC[6];
+} NRF_TIMER_Type;
+
+typedef struct {
+    volatile uint32_t EEP;
+    volatile uint32_t TEP;
+} PPI_CH_Type;
+
+typedef struct {
+    volatile uint32_t CHEN;
+    volatile uint32_t CHENSET;
+    volatile uint32_t CHENCLR;
+    PPI_CH_Type CH[20];
+} NRF_PPI_Type;
+
+typedef struct {
+    volatile uint32_t TASKS_HFCLKSTART;
+    volatile uint32_t TASKS_HFCLKSTOP;
+    volatile uint32_t EVENTS_HFCLKSTARTED;
+    volatile uint32_t HFCLKSTAT;
+} NRF_CLOCK_Type;
+
+typedef struct _radiosim_regs_t {
+    NRF_RADIO_Type radio;
+    NRF_TIMER_Type timer4;
+    NRF_PPI_Type ppi;
+    NRF_CLOCK_Type clock;
+} radiosim_regs_t;
+
+// The firmware's read-only view of the peripherals.
+extern radiosim_regs_t *radiosim_regs;
+
+#define NRF_RADIO (&radiosim_regs->radio)
+#define NRF_TIMER4 (&radiosim_regs->timer4)
+#define NRF_PPI (&radiosim_regs->ppi)
+#define NRF_CLOCK (&radiosim_regs->clock)
+
+#define RADIO_SHORTS_READY_START_Msk (1 << 0)
+#define RADIO_SHORTS_END_DISABLE_Msk (1 << 1)
+#define RADIO_SHORTS_DISABLED_TXEN_Msk (1 << 2)
+#define RADIO_SHORTS_DISABLED_RXEN_Msk (1 << 3)
+#define RADIO_SHORTS_ADDRESS_RSSISTART_Msk (1 << 4)
+#define RADIO_SHORTS_END_START_Msk (1 << 5)
+
+#define RADIO_INTENSET_READY_Msk (1 << 0)
+#define RADIO_INTENSET_ADDRESS_Msk (1 << 1)
+#define RADIO_INTENSET_PAYLOAD_Msk (1 << 2)
+#define RADIO_INTENSET_END_Msk (1 << 3)
+#define RADIO_INTENSET_DISABLED_Msk (1 << 4)
+
+#define RADIO_MODE_MODE_Nrf_1Mbit (0)
+#define RADIO_MODE_MODE_Nrf_2Mbit (1)
+#define RADIO_MODE_MODE_Nrf_250Kbit (2)
+
+#define RADIO_CRCCNF_LEN_Two (2)
+#define RADIO_MODECNF0_RU_Pos (0)
+#define RADIO_MODECNF0_RU_Fast (1)
+
+#define TIMER_INTENSET_COMPARE0_Msk (1 << 16)
+#define TIMER_MODE_MODE_Timer (0)
+#define TIMER_BITMODE_BITMODE_32Bit (3)
+
+#define CLOCK_HFCLKSTAT_SRC_Msk (1 << 0)
+#define CLOCK_HFCLKSTAT_STATE_Msk (1 << 16)
+
+#define __DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+void __disable_irq(void);
+void __enable_irq(void);
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+
+#endif // MICROPY_INCLUDED_RADIOSIM_NRF_H
@@ -0,0 +1,41 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MICROPY_INCLUDED_RADIOSIM_PY_MPHAL_H
+#define MICROPY_INCLUDED_RADIOSIM_PY_MPHAL_H
+
+#include "py/runtime.h"
+
+// Time runs at the simulator's rate, see radiosim_config_t.time_scale.
+uint32_t mp_hal_ticks_us(void);
+uint32_t mp_hal_ticks_ms(void);
+mp_uint_t mp_hal_ticks_cpu(void);
+
+uint32_t radiosim_begin_atomic_section(void);
+void radiosim_end_atomic_section(uint32_t state);
+#define MICROPY_BEGIN_ATOMIC_SECTION() radiosim_begin_atomic_section()
+#define MICROPY_END_ATOMIC_SECTION(state) radiosim_end_atomic_section(state)
+
+#endif // MICROPY_INCLUDED_RADIOSIM_PY_MPHAL_H
@@ -0,0 +1,111 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MICROPY_INCLUDED_RADIOSIM_PY_RUNTIME_H
+#define MICROPY_INCLUDED_RADIOSIM_PY_RUNTIME_H
+
+// Host stand-in for the few parts of the MicroPython runtime that drv_radio.c
+// uses.  Objects are plain C pointers: a callback is a radiosim_fun_0_t and a
+// stream is a radiosim_stream_t.  The scheduler, nlr and the atomic sections
+// behave as they do on the device, see radiosim.c.
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nrf.h"
+
+#ifndef MIN
+#define MIN(x, y) ((x) < (y) ? (x) : (y))
+#endif
+#ifndef MAX
+#define MAX(x, y) ((x) > (y) ? (x) : (y))
+#endif
+
+#define MP_ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+typedef void *mp_obj_t;
+typedef uintptr_t mp_uint_t;
+
+extern const int radiosim_none_obj;
+#define mp_const_none ((mp_obj_t)&radiosim_none_obj)
+#define MP_OBJ_NULL ((mp_obj_t)NULL)
+#define MP_OBJ_FROM_PTR(p) ((mp_obj_t)(p))
+#define MP_OBJ_NEW_SMALL_INT(i) ((mp_obj_t)(((uintptr_t)(i) << 1) | 1))
+#define MP_OBJ_SMALL_INT_VALUE(o) ((intptr_t)(o) >> 1)
+
+// A callback for microbit_radio_set_rx_callback().
+typedef struct _radiosim_fun_0_t {
+    void (*fun)(void);
+} radiosim_fun_0_t;
+
+typedef struct _radiosim_fun_1_t {
+    mp_obj_t (*fun)(mp_obj_t);
+} radiosim_fun_1_t;
+
+#define MP_DEFINE_CONST_FUN_OBJ_1(obj_name, fun_name) \
+    const radiosim_fun_1_t obj_name = { fun_name }
+
+void mp_call_function_0(mp_obj_t fun);
+
+// Root pointers are plain globals, there is no GC.
+typedef struct _radiosim_state_port_t {
+    uint8_t *radio_buf;
+    mp_obj_t radio_rx_callback;
+    uint8_t *radio_capture_buf;
+} radiosim_state_port_t;
+
+extern radiosim_state_port_t radiosim_state_port;
+#define MP_STATE_PORT(x) (radiosim_state_port.x)
+#define MP_REGISTER_ROOT_POINTER(x)
+
+// The heap is ordinary malloc, which the simulator keeps below 4GB so buffer
+// addresses fit in PACKETPTR.
+void *radiosim_alloc(size_t n);
+void radiosim_free(void *ptr);
+#define m_new(type, num) ((type *)radiosim_alloc(sizeof(type) * (num)))
+#define m_del(type, ptr, num) ((void)(num), radiosim_free(ptr))
+
+bool mp_sched_schedule(mp_obj_t function, mp_obj_t arg);
+void mp_sched_lock(void);
+void mp_sched_unlock(void);
+void mp_handle_pending(bool raise_exc);
+
+typedef struct _nlr_buf_t {
+    struct _nlr_buf_t *prev;
+    void *ret_val;
+    jmp_buf jmpbuf;
+} nlr_buf_t;
+
+extern nlr_buf_t *radiosim_nlr_top;
+#define nlr_push(buf) ((buf)->prev = radiosim_nlr_top, radiosim_nlr_top = (buf), setjmp((buf)->jmpbuf))
+#define nlr_pop() (radiosim_nlr_top = radiosim_nlr_top->prev)
+void nlr_jump(void *val) __attribute__((noreturn));
+
+uint32_t rng_generate_random_word(void);
+
+#endif // MICROPY_INCLUDED_RADIOSIM_PY_RUNTIME_H
@@ -0,0 +1,41 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MICROPY_INCLUDED_RADIOSIM_PY_STREAM_H
+#define MICROPY_INCLUDED_RADIOSIM_PY_STREAM_H
+
+#include "py/runtime.h"
+
+#define MP_STREAM_RW_WRITE (2)
+
+// A stream for microbit_radio_capture_drain(), write returns the number of bytes
+// it took.
+typedef struct _radiosim_stream_t {
+    size_t (*write)(struct _radiosim_stream_t *self, const uint8_t *buf, size_t len);
+} radiosim_stream_t;
+
+mp_obj_t mp_stream_write(mp_obj_t stream, const void *buf, size_t len, uint8_t flags);
+
+#endif // MICROPY_INCLUDED_RADIOSIM_PY_STREAM_H
@@ -0,0 +1,1096 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+
+#include <malloc.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "py/runtime.h"
+#include "py/mphal.h"
+#include "py/stream.h"
+#include "drv_softtimer.h"
+#include "radiosim.h"
+
+#if !defined(__x86_64__) || !defined(__linux__)
+#error "radiosim needs x86-64 Linux"
+#endif
+
+// The driver's IRQ handlers, normally installed by main.cpp.
+void microbit_radio_irq_handler(void);
+void microbit_radio_timer_irq_handler(void);
+
+#define REGS_SIZE (4096)
+#define REG(field) offsetof(radiosim_regs_t, field)
+#define EFLAGS_TF (0x100)
+#define MAX_DELIVERIES (64)
+
+typedef enum {
+    RS_DISABLED,
+    RS_RXRU, // ramping up the receiver
+    RS_RXIDLE,
+    RS_RX, // listening
+    RS_RXBUSY, // receiving a packet
+    RS_TXRU, // ramping up the transmitter
+    RS_TXIDLE,
+    RS_TX, // sending the preamble and address
+    RS_TXPAYLOAD, // sending the rest of the packet
+    RS_DISABLING,
+} radio_model_state_t;
+
+// A packet on air, as sent between the nodes.
+typedef struct _air_packet_t {
+    uint8_t src;
+    uint8_t mode;
+    uint8_t frequency;
+    uint8_t prefix;
+    uint32_t base;
+    uint64_t start_us; // simulated time the transmission started
+    uint8_t len;
+    uint8_t payload[255];
+} air_packet_t;
+
+typedef struct _delivery_t {
+    uint64_t time_us; // time of the ADDRESS event at the receiver
+    int8_t rssi;
+    air_packet_t pkt;
+} delivery_t;
+
+typedef struct _shared_t {
+    pthread_barrier_t barrier;
+} shared_t;
+
+// State common to all the nodes, set up before they are forked.
+static radiosim_config_t sim_config;
+static shared_t *sim_shared;
+static uint64_t sim_t0_ns;
+static char sim_name[32];
+
+// Per node state.
+static int sim_node;
+static int sim_sock;
+static int sim_wake_fd;
+static uint32_t sim_rng_state;
+static pthread_t sim_fw_thread;
+static pthread_mutex_t hw_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+radiosim_regs_t *radiosim_regs;
+static radiosim_regs_t *hw; // read-write alias of the registers, for the model
+
+// The register write being single-stepped.
+static size_t fault_offset;
+static sigset_t fault_mask;
+
+// Interrupt state of the firmware thread.  The hardware thread only sets
+// irq_softtimer_pending.
+static volatile sig_atomic_t irq_primask;
+static volatile sig_atomic_t irq_radio_enabled;
+static volatile sig_atomic_t irq_radio_pending;
+static volatile sig_atomic_t irq_timer_enabled;
+static volatile sig_atomic_t irq_timer_pending;
+static volatile sig_atomic_t irq_softtimer_pending;
+
+// Model state, protected by hw_mutex.
+static uint32_t radio_inten;
+static radio_model_state_t radio_model_state;
+static uint64_t radio_deadline;
+static uint64_t radio_tx_start_us;
+static uint8_t *radio_dma; // PACKETPTR latched at START
+static air_packet_t radio_rx_pkt;
+static bool radio_rx_collided;
+static delivery_t deliveries[MAX_DELIVERIES]; // sorted by time
+static size_t num_deliveries;
+static uint32_t timer_inten;
+static bool timer_running;
+static uint32_t timer_held; // count when stopped, or when started
+static uint64_t timer_start_us;
+static uint32_t timer_last; // count at timer_last_us, compares up to here have fired
+static uint64_t timer_last_us;
+static uint32_t ppi_chen;
+static uint64_t softtimer_due_us = UINT64_MAX;
+
+/******************************************************************************/
+// Time, interrupts and the runtime stubs.
+
+static uint64_t real_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t sim_us(void) {
+    return (real_ns() - sim_t0_ns) / 1000 / sim_config.time_scale;
+}
+
+uint32_t radiosim_now_us(void) {
+    return sim_us();
+}
+
+uint32_t mp_hal_ticks_us(void) {
+    return sim_us();
+}
+
+uint32_t mp_hal_ticks_ms(void) {
+    return sim_us() / 1000;
+}
+
+mp_uint_t mp_hal_ticks_cpu(void) {
+    return sim_us() * 64;
+}
+
+uint32_t rng_generate_random_word(void) {
+    sim_rng_state ^= sim_rng_state << 13;
+    sim_rng_state ^= sim_rng_state >> 17;
+    sim_rng_state ^= sim_rng_state << 5;
+    return sim_rng_state;
+}
+
+static bool radio_line(void) {
+    const NRF_RADIO_Type *r = &hw->radio;
+    return ((radio_inten & RADIO_INTENSET_READY_Msk) && r->EVENTS_READY)
+           || ((radio_inten & RADIO_INTENSET_ADDRESS_Msk) && r->EVENTS_ADDRESS)
+           || ((radio_inten & RADIO_INTENSET_PAYLOAD_Msk) && r->EVENTS_PAYLOAD)
+           || ((radio_inten & RADIO_INTENSET_END_Msk) && r->EVENTS_END)
+           || ((radio_inten & RADIO_INTENSET_DISABLED_Msk) && r->EVENTS_DISABLED);
+}
+
+static bool timer_line(void) {
+    for (int n = 0; n < 6; ++n) {
+        if ((timer_inten & (TIMER_INTENSET_COMPARE0_Msk << n)) && hw->timer4.EVENTS_COMPARE[n]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Ask the firmware thread to look for interrupts to take.  From the firmware thread
+// itself this happens straight away, unless SIGUSR1 is blocked.
+static void irq_kick(void) {
+    pthread_kill(sim_fw_thread, SIGUSR1);
+}
+
+static void soft_timer_run(void);
+
+// The SIGUSR1 handler, which plays the part of the NVIC.  Peripheral interrupt
+// lines are level triggered, so a handler runs again if it leaves its event set.
+static void irq_dispatch(int sig) {
+    (void)sig;
+    while (!irq_primask) {
+        if (irq_radio_enabled && (irq_radio_pending || radio_line())) {
+            irq_radio_pending = 0;
+            microbit_radio_irq_handler();
+        } else if (irq_timer_enabled && (irq_timer_pending || timer_line())) {
+            irq_timer_pending = 0;
+            microbit_radio_timer_irq_handler();
+        } else if (irq_softtimer_pending) {
+            irq_softtimer_pending = 0;
+            soft_timer_run();
+        } else {
+            break;
+        }
+    }
+}
+
+void __disable_irq(void) {
+    irq_primask = 1;
+}
+
+void __enable_irq(void) {
+    irq_primask = 0;
+    irq_kick();
+}
+
+uint32_t radiosim_begin_atomic_section(void) {
+    uint32_t state = irq_primask;
+    irq_primask = 1;
+    return state;
+}
+
+void radiosim_end_atomic_section(uint32_t state) {
+    irq_primask = state;
+    if (!state) {
+        irq_kick();
+    }
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq) {
+    if (irq == RADIO_IRQn) {
+        irq_radio_enabled = 1;
+    } else {
+        irq_timer_enabled = 1;
+    }
+    irq_kick();
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq) {
+    if (irq == RADIO_IRQn) {
+        irq_radio_enabled = 0;
+    } else {
+        irq_timer_enabled = 0;
+    }
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irq) {
+    if (irq == RADIO_IRQn) {
+        irq_radio_pending = 1;
+    } else {
+        irq_timer_pending = 1;
+    }
+    irq_kick();
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq) {
+    if (irq == RADIO_IRQn) {
+        irq_radio_pending = 0;
+    } else {
+        irq_timer_pending = 0;
+    }
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {
+    (void)irq;
+    (void)priority;
+}
+
+// Take hw_mutex from the firmware thread.  Interrupts are masked while it's held,
+// because a handler that writes a register needs the mutex too.
+static void fw_lock(sigset_t *old) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &set, old);
+    pthread_mutex_lock(&hw_mutex);
+}
+
+static void fw_unlock(const sigset_t *old) {
+    pthread_mutex_unlock(&hw_mutex);
+    pthread_sigmask(SIG_SETMASK, old, NULL);
+}
+
+static void hw_wake(void) {
+    uint64_t one = 1;
+    if (write(sim_wake_fd, &one, sizeof(one)) < 0) {
+        // the hardware thread is already due to wake
+    }
+}
+
+const int radiosim_none_obj = 0;
+radiosim_state_port_t radiosim_state_port;
+nlr_buf_t *radiosim_nlr_top;
+
+static struct {
+    const radiosim_fun_1_t *fun;
+    mp_obj_t arg;
+} sched_queue[8];
+static volatile size_t sched_len;
+static unsigned int sched_lock_depth;
+static void *pending_exception;
+
+void *radiosim_alloc(size_t n) {
+    void *ptr = malloc(n);
+    if (ptr == NULL || (uintptr_t)ptr + n > UINT32_MAX) {
+        // EasyDMA only takes 32-bit addresses
+        fprintf(stderr, "radiosim: allocation of %zu bytes failed or is above 4GB\n", n);
+        abort();
+    }
+    return ptr;
+}
+
+void radiosim_free(void *ptr) {
+    free(ptr);
+}
+
+void mp_call_function_0(mp_obj_t fun) {
+    ((const radiosim_fun_0_t *)fun)->fun();
+}
+
+bool mp_sched_schedule(mp_obj_t function, mp_obj_t arg) {
+    bool ret = false;
+    uint32_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    if (sched_len < MP_ARRAY_SIZE(sched_queue)) {
+        sched_queue[sched_len].fun = function;
+        sched_queue[sched_len].arg = arg;
+        ++sched_len;
+        ret = true;
+    }
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
+    return ret;
+}
+
+void mp_sched_lock(void) {
+    ++sched_lock_depth;
+}
+
+void mp_sched_unlock(void) {
+    --sched_lock_depth;
+}
+
+// As in MicroPython, a pending exception is raised even while the scheduler is
+// locked, but callbacks only run once it is unlocked.
+void mp_handle_pending(bool raise_exc) {
+    if (pending_exception != NULL && raise_exc) {
+        void *exc = pending_exception;
+        pending_exception = NULL;
+        nlr_jump(exc);
+    }
+    while (sched_lock_depth == 0 && sched_len != 0) {
+        uint32_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+        const radiosim_fun_1_t *fun = sched_queue[0].fun;
+        mp_obj_t arg = sched_queue[0].arg;
+        --sched_len;
+        memmove(&sched_queue[0], &sched_queue[1], sched_len * sizeof(sched_queue[0]));
+        MICROPY_END_ATOMIC_SECTION(atomic_state);
+        fun->fun(arg);
+    }
+}
+
+void radiosim_set_pending_exception(void *exc) {
+    pending_exception = exc;
+}
+
+void nlr_jump(void *val) {
+    nlr_buf_t *top = radiosim_nlr_top;
+    if (top == NULL) {
+        fprintf(stderr, "radiosim: uncaught exception %p\n", val);
+        abort();
+    }
+    radiosim_nlr_top = top->prev;
+    top->ret_val = val;
+    longjmp(top->jmpbuf, 1);
+}
+
+mp_obj_t mp_stream_write(mp_obj_t stream, const void *buf, size_t len, uint8_t flags) {
+    (void)flags;
+    radiosim_stream_t *s = stream;
+    size_t n = s->write(s, buf, len);
+    // like a non-blocking stream that can't take any more
+    return n == 0 ? mp_const_none : MP_OBJ_NEW_SMALL_INT(n);
+}
+
+/******************************************************************************/
+// Soft timers, for C callbacks only.  The list belongs to the firmware thread,
+// which tells the hardware thread when the next one is due.
+
+static microbit_soft_timer_entry_t *soft_timers;
+
+static void soft_timer_publish(void) {
+    uint64_t due = UINT64_MAX;
+    for (microbit_soft_timer_entry_t *e = soft_timers; e != NULL; e = (microbit_soft_timer_entry_t *)e->pairheap.next) {
+        due = MIN(due, (uint64_t)e->expiry_ms * 1000);
+    }
+    sigset_t old;
+    fw_lock(&old);
+    softtimer_due_us = due;
+    fw_unlock(&old);
+    hw_wake();
+}
+
+static void soft_timer_unlink(microbit_soft_timer_entry_t *entry) {
+    for (mp_pairheap_t **p = (mp_pairheap_t **)&soft_timers; *p != NULL; p = &(*p)->next) {
+        if (*p == &entry->pairheap) {
+            *p = entry->pairheap.next;
+            break;
+        }
+    }
+}
+
+static void soft_timer_run(void) {
+    uint32_t now = mp_hal_ticks_ms();
+    microbit_soft_timer_entry_t *e = soft_timers;
+    while (e != NULL) {
+        microbit_soft_timer_entry_t *next = (microbit_soft_timer_entry_t *)e->pairheap.next;
+        if ((int32_t)(e->expiry_ms - now) <= 0) {
+            e->c_callback(e);
+            if (e->mode == MICROBIT_SOFT_TIMER_MODE_PERIODIC) {
+                e->expiry_ms += e->delta_ms;
+            } else {
+                soft_timer_unlink(e);
+            }
+        }
+        e = next;
+    }
+    soft_timer_publish();
+}
+
+void microbit_soft_timer_insert(microbit_soft_timer_entry_t *entry, uint32_t initial_delta_ms) {
+    entry->expiry_ms = mp_hal_ticks_ms() + initial_delta_ms;
+    uint32_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    entry->pairheap.next = (mp_pairheap_t *)soft_timers;
+    soft_timers = entry;
+    soft_timer_publish();
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
+}
+
+void microbit_soft_timer_remove(microbit_soft_timer_entry_t *entry) {
+    uint32_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    soft_timer_unlink(entry);
+    soft_timer_publish();
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
+}
+
+/******************************************************************************/
+// The peripheral model.  All of this runs with hw_mutex held, at simulated time t.
+
+static void hw_task(size_t offset, uint64_t t);
+
+static uint32_t radio_bit_rate_div(uint32_t *mul) {
+    // air time in us of a byte is 8 * mul / div
+    switch (hw->radio.MODE) {
+        case RADIO_MODE_MODE_Nrf_2Mbit:
+            *mul = 1;
+            return 2;
+        case RADIO_MODE_MODE_Nrf_250Kbit:
+            *mul = 4;
+            return 1;
+        default:
+            *mul = 1;
+            return 1;
+    }
+}
+
+// Time in us from the start of a packet to its ADDRESS event, and to its END.
+static uint32_t radio_address_time_us(void) {
+    uint32_t mul;
+    uint32_t div = radio_bit_rate_div(&mul);
+    uint32_t preamble = hw->radio.MODE == RADIO_MODE_MODE_Nrf_2Mbit ? 2 : 1;
+    return 8 * (preamble + 5) * mul / div;
+}
+
+static uint32_t radio_air_time_us(size_t len) {
+    uint32_t mul;
+    uint32_t div = radio_bit_rate_div(&mul);
+    return radio_address_time_us() + 8 * (1 + len + 2) * mul / div;
+}
+
+static uint32_t radio_ramp_up_us(void) {
+    return hw->radio.MODECNF0 & 1 ? 40 : 140;
+}
+
+static uint32_t radio_prefix(uint32_t addr) {
+    uint32_t prefixes = addr < 4 ? hw->radio.PREFIX0 : hw->radio.PREFIX1;
+    return (prefixes >> (8 * (addr & 3))) & 0xff;
+}
+
+static uint32_t radio_base(uint32_t addr) {
+    return addr == 0 ? hw->radio.BASE0 : hw->radio.BASE1;
+}
+
+static uint8_t *dma_ptr(uint32_t addr) {
+    return (uint8_t *)(uintptr_t)addr;
+}
+
+// Fire a peripheral event, along with any PPI tasks hooked to it.
+static void hw_event(volatile uint32_t *event, uint64_t t) {
+    *event = 1;
+    uint32_t address = (uint32_t)(uintptr_t)radiosim_regs + ((uint8_t *)event - (uint8_t *)hw);
+    for (int ch = 0; ch < 20; ++ch) {
+        if ((ppi_chen & (1 << ch)) && hw->ppi.CH[ch].EEP == address) {
+            size_t offset = hw->ppi.CH[ch].TEP - (uint32_t)(uintptr_t)radiosim_regs;
+            if (offset < sizeof(radiosim_regs_t)) {
+                hw_task(offset, t);
+            }
+        }
+    }
+    irq_kick();
+}
+
+static uint32_t timer_count(uint64_t t) {
+    return timer_running ? timer_held + (uint32_t)(t - timer_start_us) : timer_held;
+}
+
+// Fire the compares the count has reached since it was last checked.
+static void timer_check(uint64_t t) {
+    if (!timer_running) {
+        return;
+    }
+    uint32_t count = timer_count(t);
+    uint32_t span = count - timer_last;
+    for (int n = 0; n < 6; ++n) {
+        uint32_t d = hw->timer4.CC[n] - timer_last;
+        if (d != 0 && d <= span) {
+            hw_event(&hw->timer4.EVENTS_COMPARE[n], t);
+        }
+    }
+    timer_last = count;
+    timer_last_us = t;
+}
+
+static uint64_t timer_next_compare(void) {
+    if (!timer_running) {
+        return UINT64_MAX;
+    }
+    uint64_t next = UINT64_MAX;
+    for (int n = 0; n < 6; ++n) {
+        uint32_t d = hw->timer4.CC[n] - timer_last;
+        if (d != 0) {
+            next = MIN(next, timer_last_us + d);
+        }
+    }
+    return next;
+}
+
+// DISABLE always ends with a DISABLED event, even if the radio was disabled
+// already; the driver's enable and disable wait for it.
+static void radio_disable(uint64_t t) {
+    if (radio_model_state != RS_DISABLING) {
+        radio_model_state = RS_DISABLING;
+        radio_deadline = t + 2;
+    }
+}
+
+static void medium_send(const air_packet_t *pkt) {
+    size_t size = offsetof(air_packet_t, payload) + pkt->len;
+    for (int i = 0; i < sim_config.num_nodes; ++i) {
+        if (i != sim_node && sim_config.links[sim_node][i] != 0) {
+            struct sockaddr_un addr = { .sun_family = AF_UNIX };
+            int n = snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1, "%s-%d", sim_name, i);
+            // a full socket buffer is a lost packet
+            sendto(sim_sock, pkt, size, MSG_DONTWAIT, (struct sockaddr *)&addr, offsetof(struct sockaddr_un, sun_path) + 1 + n);
+        }
+    }
+}
+
+static void radio_start(uint64_t t) {
+    if (radio_model_state == RS_TXIDLE) {
+        // send the packet, which the receivers time from its start
+        radio_dma = dma_ptr(hw->radio.PACKETPTR);
+        air_packet_t pkt;
+        uint32_t txaddr = hw->radio.TXADDRESS & 7;
+        pkt.src = sim_node;
+        pkt.mode = hw->radio.MODE;
+        pkt.frequency = hw->radio.FREQUENCY;
+        pkt.prefix = radio_prefix(txaddr);
+        pkt.base = radio_base(txaddr);
+        pkt.start_us = t;
+        pkt.len = MIN(radio_dma[0], hw->radio.PCNF1 & 0xff);
+        memcpy(pkt.payload, radio_dma + 1, pkt.len);
+        medium_send(&pkt);
+        radio_model_state = RS_TX;
+        radio_tx_start_us = t;
+        radio_deadline = t + radio_address_time_us();
+    } else if (radio_model_state == RS_RXIDLE) {
+        radio_dma = dma_ptr(hw->radio.PACKETPTR);
+        radio_model_state = RS_RX;
+    }
+}
+
+static void radio_end(uint64_t t, bool rx) {
+    radio_model_state = rx ? RS_RXIDLE : RS_TXIDLE;
+    radio_deadline = UINT64_MAX;
+    hw_event(&hw->radio.EVENTS_PAYLOAD, t);
+    hw_event(&hw->radio.EVENTS_END, t);
+    if (hw->radio.SHORTS & RADIO_SHORTS_END_DISABLE_Msk) {
+        radio_disable(t);
+    } else if (hw->radio.SHORTS & RADIO_SHORTS_END_START_Msk) {
+        radio_start(t);
+    }
+}
+
+static void radio_timeout(uint64_t t) {
+    radio_deadline = UINT64_MAX;
+    switch (radio_model_state) {
+        case RS_RXRU:
+        case RS_TXRU:
+            radio_model_state = radio_model_state == RS_RXRU ? RS_RXIDLE : RS_TXIDLE;
+            hw_event(&hw->radio.EVENTS_READY, t);
+            if (hw->radio.SHORTS & RADIO_SHORTS_READY_START_Msk) {
+                radio_start(t);
+            }
+            break;
+        case RS_TX:
+            radio_model_state = RS_TXPAYLOAD;
+            radio_deadline = radio_tx_start_us + radio_air_time_us(MIN(radio_dma[0], hw->radio.PCNF1 & 0xff));
+            hw_event(&hw->radio.EVENTS_ADDRESS, t);
+            break;
+        case RS_TXPAYLOAD:
+            radio_end(t, false);
+            break;
+        case RS_RXBUSY: {
+            // EasyDMA writes the length as received, and at most MAXLEN bytes
+            size_t max_len = hw->radio.PCNF1 & 0xff;
+            radio_dma[0] = radio_rx_pkt.len;
+            memcpy(radio_dma + 1, radio_rx_pkt.payload, MIN(radio_rx_pkt.len, max_len));
+            hw->radio.CRCSTATUS = !radio_rx_collided && radio_rx_pkt.len <= max_len;
+            radio_end(t, true);
+            break;
+        }
+        case RS_DISABLING:
+            radio_model_state = RS_DISABLED;
+            hw_event(&hw->radio.EVENTS_DISABLED, t);
+            if (hw->radio.SHORTS & RADIO_SHORTS_DISABLED_TXEN_Msk) {
+                hw_task(REG(radio.TASKS_TXEN), t);
+            } else if (hw->radio.SHORTS & RADIO_SHORTS_DISABLED_RXEN_Msk) {
+                hw_task(REG(radio.TASKS_RXEN), t);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// A packet reaches this node's antenna, at the time of its ADDRESS event.
+static void medium_deliver(uint64_t t) {
+    delivery_t d = deliveries[0];
+    --num_deliveries;
+    memmove(&deliveries[0], &deliveries[1], num_deliveries * sizeof(deliveries[0]));
+
+    if (radio_model_state == RS_RXBUSY) {
+        if (sim_config.collisions) {
+            radio_rx_collided = true;
+        }
+        return;
+    }
+    if (radio_model_state != RS_RX || d.pkt.frequency != hw->radio.FREQUENCY || d.pkt.mode != hw->radio.MODE) {
+        return;
+    }
+    for (uint32_t addr = 0; addr < 8; ++addr) {
+        if ((hw->radio.RXADDRESSES & (1 << addr)) && radio_base(addr) == d.pkt.base && radio_prefix(addr) == d.pkt.prefix) {
+            radio_model_state = RS_RXBUSY;
+            radio_rx_pkt = d.pkt;
+            radio_rx_collided = false;
+            hw->radio.RXMATCH = addr;
+            hw->radio.RSSISAMPLE = -d.rssi;
+            radio_deadline = d.pkt.start_us + radio_air_time_us(d.pkt.len);
+            radio_deadline = MAX(radio_deadline, t);
+            hw_event(&hw->radio.EVENTS_ADDRESS, t);
+            return;
+        }
+    }
+}
+
+static void medium_receive(const air_packet_t *pkt) {
+    int8_t rssi = sim_config.links[pkt->src][sim_node];
+    double r = (rng_generate_random_word() >> 8) / (double)(1 << 24);
+    if (rssi == 0 || r < sim_config.loss || num_deliveries == MAX_DELIVERIES) {
+        return;
+    }
+    uint64_t t = pkt->start_us + sim_config.latency_us + radio_address_time_us();
+    if (sim_config.jitter_us != 0) {
+        t += rng_generate_random_word() % sim_config.jitter_us;
+    }
+    // a packet the host delivered late arrives now
+    t = MAX(t, sim_us());
+    size_t i = num_deliveries;
+    while (i > 0 && deliveries[i - 1].time_us > t) {
+        deliveries[i] = deliveries[i - 1];
+        --i;
+    }
+    deliveries[i].time_us = t;
+    deliveries[i].rssi = rssi;
+    deliveries[i].pkt = *pkt;
+    ++num_deliveries;
+}
+
+static void hw_task(size_t offset, uint64_t t) {
+    switch (offset) {
+        case REG(radio.TASKS_TXEN):
+        case REG(radio.TASKS_RXEN):
+            if (radio_model_state == RS_DISABLED) {
+                radio_model_state = offset == REG(radio.TASKS_TXEN) ? RS_TXRU : RS_RXRU;
+                radio_deadline = t + radio_ramp_up_us();
+            }
+            break;
+        case REG(radio.TASKS_START):
+            radio_start(t);
+            break;
+        case REG(radio.TASKS_STOP):
+            if (radio_model_state == RS_RX || radio_model_state == RS_RXBUSY) {
+                radio_model_state = RS_RXIDLE;
+                radio_deadline = UINT64_MAX;
+            } else if (radio_model_state == RS_TX || radio_model_state == RS_TXPAYLOAD) {
+                radio_model_state = RS_TXIDLE;
+                radio_deadline = UINT64_MAX;
+            }
+            break;
+        case REG(radio.TASKS_DISABLE):
+            radio_disable(t);
+            break;
+        case REG(timer4.TASKS_START):
+            if (!timer_running) {
+                timer_running = true;
+                timer_start_us = t;
+                timer_last = timer_held;
+                timer_last_us = t;
+            }
+            break;
+        case REG(timer4.TASKS_STOP):
+            timer_check(t);
+            timer_held = timer_count(t);
+            timer_running = false;
+            break;
+        case REG(timer4.TASKS_CLEAR):
+            timer_check(t);
+            timer_held = 0;
+            timer_start_us = t;
+            timer_last = 0;
+            timer_last_us = t;
+            break;
+        case REG(clock.TASKS_HFCLKSTART):
+            hw->clock.HFCLKSTAT = CLOCK_HFCLKSTAT_SRC_Msk | CLOCK_HFCLKSTAT_STATE_Msk;
+            hw_event(&hw->clock.EVENTS_HFCLKSTARTED, t);
+            break;
+        case REG(clock.TASKS_HFCLKSTOP):
+            hw->clock.HFCLKSTAT = 0;
+            break;
+        default:
+            if (offset >= REG(timer4.TASKS_CAPTURE) && offset < REG(timer4.TASKS_CAPTURE[6])) {
+                timer_check(t);
+                hw->timer4.CC[(offset - REG(timer4.TASKS_CAPTURE)) / 4] = timer_count(t);
+            }
+            break;
+    }
+}
+
+static bool hw_is_task(size_t offset) {
+    return (offset >= REG(radio.TASKS_TXEN) && offset <= REG(radio.TASKS_RSSISTART))
+           || (offset >= REG(timer4.TASKS_START) && offset <= REG(timer4.TASKS_CAPTURE[5]))
+           || offset == REG(clock.TASKS_HFCLKSTART)
+           || offset == REG(clock.TASKS_HFCLKSTOP);
+}
+
+// The firmware has written a register.
+static void hw_write(size_t offset, uint64_t t) {
+    volatile uint32_t *reg = (volatile uint32_t *)((uint8_t *)hw + offset);
+    uint32_t value = *reg;
+    switch (offset) {
+        case REG(radio.INTENSET):
+        case REG(radio.INTENCLR):
+            radio_inten = offset == REG(radio.INTENSET) ? radio_inten | value : radio_inten & ~value;
+            hw->radio.INTENSET = hw->radio.INTENCLR = radio_inten;
+            break;
+        case REG(timer4.INTENSET):
+        case REG(timer4.INTENCLR):
+            timer_inten = offset == REG(timer4.INTENSET) ? timer_inten | value : timer_inten & ~value;
+            hw->timer4.INTENSET = hw->timer4.INTENCLR = timer_inten;
+            break;
+        case REG(ppi.CHEN):
+        case REG(ppi.CHENSET):
+        case REG(ppi.CHENCLR):
+            ppi_chen = offset == REG(ppi.CHEN) ? value : offset == REG(ppi.CHENSET) ? ppi_chen | value : ppi_chen & ~value;
+            hw->ppi.CHEN = hw->ppi.CHENSET = hw->ppi.CHENCLR = ppi_chen;
+            break;
+        default:
+            if (value != 0 && hw_is_task(offset)) {
+                hw_task(offset, t);
+            }
+            break;
+    }
+}
+
+static uint64_t hw_next_deadline(void) {
+    uint64_t next = MIN(radio_deadline, timer_next_compare());
+    next = MIN(next, softtimer_due_us);
+    if (num_deliveries != 0) {
+        next = MIN(next, deliveries[0].time_us);
+    }
+    return next;
+}
+
+// Run the model up to time now, taking things in the order they happen.
+static void hw_advance(uint64_t now) {
+    for (;;) {
+        uint64_t t = hw_next_deadline();
+        if (t > now) {
+            break;
+        }
+        if (t == timer_next_compare()) {
+            timer_check(t);
+        } else if (t == radio_deadline) {
+            radio_timeout(t);
+        } else if (num_deliveries != 0 && t == deliveries[0].time_us) {
+            medium_deliver(t);
+        } else {
+            softtimer_due_us = UINT64_MAX;
+            irq_softtimer_pending = 1;
+            irq_kick();
+        }
+    }
+    timer_check(now);
+}
+
+static void *hw_thread(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&hw_mutex);
+        uint64_t now = sim_us();
+        hw_advance(now);
+        uint64_t next = hw_next_deadline();
+        pthread_mutex_unlock(&hw_mutex);
+
+        struct timespec ts;
+        struct timespec *timeout = NULL;
+        if (next != UINT64_MAX) {
+            uint64_t ns = next > now ? (next - now) * 1000 * sim_config.time_scale : 0;
+            ts.tv_sec = ns / 1000000000;
+            ts.tv_nsec = ns % 1000000000;
+            timeout = &ts;
+        }
+        struct pollfd fds[2] = { { sim_sock, POLLIN, 0 }, { sim_wake_fd, POLLIN, 0 } };
+        ppoll(fds, 2, timeout, NULL);
+        if (fds[0].revents & POLLIN) {
+            air_packet_t pkt;
+            while (recv(sim_sock, &pkt, sizeof(pkt), MSG_DONTWAIT) > 0) {
+                pthread_mutex_lock(&hw_mutex);
+                medium_receive(&pkt);
+                pthread_mutex_unlock(&hw_mutex);
+            }
+        }
+        if (fds[1].revents & POLLIN) {
+            uint64_t n;
+            if (read(sim_wake_fd, &n, sizeof(n)) < 0) {
+                // nothing to do, the loop runs the model anyway
+            }
+        }
+    }
+    return NULL;
+}
+
+// A register write faulted: let the instruction complete, with a single step.
+static void fault_handler(int sig, siginfo_t *info, void *context) {
+    ucontext_t *uc = context;
+    uint8_t *addr = info->si_addr;
+    if (addr < (uint8_t *)radiosim_regs || addr >= (uint8_t *)radiosim_regs + REGS_SIZE) {
+        // a genuine crash
+        signal(sig, SIG_DFL);
+        return;
+    }
+    fault_offset = (addr - (uint8_t *)radiosim_regs) & ~3;
+    mprotect(radiosim_regs, REGS_SIZE, PROT_READ | PROT_WRITE);
+    fault_mask = uc->uc_sigmask;
+    sigaddset(&uc->uc_sigmask, SIGUSR1);
+    uc->uc_mcontext.gregs[REG_EFL] |= EFLAGS_TF;
+}
+
+// The register write is done, so protect the registers again and act on it.
+static void trap_handler(int sig, siginfo_t *info, void *context) {
+    (void)sig;
+    (void)info;
+    ucontext_t *uc = context;
+    uc->uc_mcontext.gregs[REG_EFL] &= ~EFLAGS_TF;
+    mprotect(radiosim_regs, REGS_SIZE, PROT_READ);
+    uc->uc_sigmask = fault_mask;
+
+    pthread_mutex_lock(&hw_mutex);
+    uint64_t t = sim_us();
+    hw_advance(t);
+    hw_write(fault_offset, t);
+    bool line = radio_line() || timer_line();
+    pthread_mutex_unlock(&hw_mutex);
+    hw_wake();
+    if (line) {
+        irq_kick();
+    }
+}
+
+/******************************************************************************/
+// Setting up the medium and the nodes.
+
+static void fail(const char *what) {
+    perror(what);
+    exit(2);
+}
+
+static void node_attach(int index) {
+    sim_node = index;
+    sim_rng_state = 0x9e3779b9 * (index + 1) ^ (uint32_t)real_ns();
+    sim_rng_state |= 1;
+
+    // keep the heap below 4GB, see radiosim_alloc()
+    mallopt(M_MMAP_THRESHOLD, 64 << 20);
+
+    int fd = memfd_create("radiosim-regs", 0);
+    if (fd < 0 || ftruncate(fd, REGS_SIZE) < 0) {
+        fail("memfd");
+    }
+    hw = mmap(NULL, REGS_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    radiosim_regs = mmap(NULL, REGS_SIZE, PROT_READ, MAP_SHARED | MAP_32BIT, fd, 0);
+    if (hw == MAP_FAILED || radiosim_regs == MAP_FAILED) {
+        fail("mmap");
+    }
+    radio_model_state = RS_DISABLED;
+    radio_deadline = UINT64_MAX;
+
+    sim_sock = socket(AF_UNIX, SOCK_DGRAM, 0);
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    int n = snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1, "%s-%d", sim_name, index);
+    if (sim_sock < 0 || bind(sim_sock, (struct sockaddr *)&addr, offsetof(struct sockaddr_un, sun_path) + 1 + n) < 0) {
+        fail("socket");
+    }
+    sim_wake_fd = eventfd(0, EFD_NONBLOCK);
+
+    struct sigaction sa = { 0 };
+    sigemptyset(&sa.sa_mask);
+    sigaddset(&sa.sa_mask, SIGUSR1);
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sa.sa_sigaction = fault_handler;
+    sigaction(SIGSEGV, &sa, NULL);
+    sigaction(SIGBUS, &sa, NULL);
+    sa.sa_sigaction = trap_handler;
+    sigaction(SIGTRAP, &sa, NULL);
+    sa.sa_flags = SA_RESTART;
+    sa.sa_handler = irq_dispatch;
+    sigaction(SIGUSR1, &sa, NULL);
+
+    // interrupts go to this thread, not the hardware thread
+    sim_fw_thread = pthread_self();
+    sigset_t old;
+    fw_lock(&old);
+    pthread_t thread;
+    pthread_create(&thread, NULL, hw_thread, NULL);
+    fw_unlock(&old);
+}
+
+static int env_int(const char *name, int def) {
+    const char *s = getenv(name);
+    return s != NULL ? atoi(s) : def;
+}
+
+void radiosim_config_init(radiosim_config_t *config, int num_nodes) {
+    memset(config, 0, sizeof(*config));
+    config->num_nodes = num_nodes;
+    for (int a = 0; a < num_nodes; ++a) {
+        for (int b = 0; b < num_nodes; ++b) {
+            config->links[a][b] = a == b ? 0 : -50;
+        }
+    }
+    const char *loss = getenv("RADIOSIM_LOSS");
+    config->loss = loss != NULL ? atof(loss) : 0;
+    config->latency_us = env_int("RADIOSIM_LATENCY_US", 0);
+    config->jitter_us = env_int("RADIOSIM_JITTER_US", 0);
+    config->collisions = env_int("RADIOSIM_COLLISIONS", 0);
+    config->time_scale = env_int("RADIOSIM_TIME_SCALE", 1);
+}
+
+void radiosim_config_link(radiosim_config_t *config, int a, int b, int8_t rssi) {
+    config->links[a][b] = rssi;
+    config->links[b][a] = rssi;
+}
+
+int radiosim_run(const radiosim_config_t *config, int (*node)(int index)) {
+    sim_config = *config;
+    if (sim_config.time_scale == 0) {
+        sim_config.time_scale = 1;
+    }
+    sim_shared = mmap(NULL, sizeof(shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&sim_shared->barrier, &attr, config->num_nodes);
+    snprintf(sim_name, sizeof(sim_name), "radiosim-%d", getpid());
+    sim_t0_ns = real_ns();
+
+    fflush(stdout);
+    pid_t pids[RADIOSIM_MAX_NODES];
+    for (int i = 0; i < config->num_nodes; ++i) {
+        pids[i] = fork();
+        if (pids[i] < 0) {
+            fail("fork");
+        } else if (pids[i] == 0) {
+            // a hung node fails rather than hanging the test
+            alarm(env_int("RADIOSIM_TIMEOUT_S", 120));
+            node_attach(i);
+            radiosim_barrier();
+            int ret = node(i);
+            fflush(stdout);
+            _exit(ret);
+        }
+    }
+
+    // The first node to fail stops the rest, which may be waiting for it at a
+    // barrier or for packets it would have sent.
+    int ret = 0;
+    for (int left = config->num_nodes; left > 0; --left) {
+        int status;
+        pid_t pid = wait(&status);
+        int i = 0;
+        while (pids[i] != pid) {
+            ++i;
+        }
+        pids[i] = 0;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            if (WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL && ret != 0) {
+                // stopped after another node failed
+                continue;
+            }
+            printf("node %d failed (status 0x%x)\n", i, status);
+            ret = 1;
+            for (int j = 0; j < config->num_nodes; ++j) {
+                if (pids[j] != 0) {
+                    kill(pids[j], SIGKILL);
+                }
+            }
+        }
+    }
+    munmap(sim_shared, sizeof(shared_t));
+    return ret;
+}
+
+void radiosim_radio_config_default(microbit_radio_config_t *config) {
+    memset(config, 0, sizeof(*config));
+    config->max_payload = MICROBIT_RADIO_DEFAULT_MAX_PAYLOAD;
+    config->queue_len = MICROBIT_RADIO_DEFAULT_QUEUE_LEN;
+    config->tx_queue_len = MICROBIT_RADIO_DEFAULT_TX_QUEUE_LEN;
+    config->channel = MICROBIT_RADIO_DEFAULT_CHANNEL;
+    config->power_dbm = MICROBIT_RADIO_DEFAULT_POWER_DBM;
+    config->base0 = MICROBIT_RADIO_DEFAULT_BASE0;
+    config->prefix0 = MICROBIT_RADIO_DEFAULT_PREFIX0;
+    config->retries = MICROBIT_RADIO_DEFAULT_RETRIES;
+    config->dwell_ms = MICROBIT_RADIO_DEFAULT_DWELL_MS;
+    config->data_rate = MICROBIT_RADIO_DEFAULT_DATA_RATE;
+}
+
+int radiosim_node_index(void) {
+    return sim_node;
+}
+
+void radiosim_barrier(void) {
+    pthread_barrier_wait(&sim_shared->barrier);
+}
+
+void radiosim_sleep_us(uint32_t us) {
+    uint64_t end = sim_us() + us;
+    uint64_t now;
+    while ((now = sim_us()) < end) {
+        mp_handle_pending(true);
+        uint64_t ns = MIN(end - now, 1000) * 1000 * sim_config.time_scale;
+        struct timespec ts = { ns / 1000000000, ns % 1000000000 };
+        nanosleep(&ts, NULL);
+    }
+    mp_handle_pending(true);
+}
@@ -0,0 +1,92 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MICROPY_INCLUDED_RADIOSIM_RADIOSIM_H
+#define MICROPY_INCLUDED_RADIOSIM_RADIOSIM_H
+
+// A virtual radio medium for running drv_radio.c on the host.
+//
+// Each node is a process running the unmodified driver against a model of the
+// nRF52 RADIO, TIMER4, PPI and CLOCK peripherals.  The registers are in a page the
+// firmware can only read: each write faults, is single-stepped, and is then handed
+// to the model, so tasks and write-to-set/clear registers act synchronously as they
+// do on the chip.  A hardware thread advances the radio state machine, the timer
+// compares and the soft timers, and raises interrupts as SIGUSR1 on the firmware
+// thread, where NVIC_DisableIRQ() and __disable_irq() mask them.
+//
+// Transmitted packets go to every other node as AF_UNIX datagrams.  Each receiver
+// applies the link between the two nodes: whether they can hear each other, the
+// RSSI, and a random loss and latency.  A packet is only received if the radio is
+// listening on the same channel, data rate and address when it arrives.
+//
+// This only runs on x86-64 Linux.
+
+#include "py/runtime.h"
+#include "drv_radio.h"
+
+#define RADIOSIM_MAX_NODES (16)
+
+typedef struct _radiosim_config_t {
+    int num_nodes;
+    // links[a][b] is the RSSI in dBm (negative) at b of packets sent by a, or 0 if b
+    // can't hear a
+    int8_t links[RADIOSIM_MAX_NODES][RADIOSIM_MAX_NODES];
+    double loss; // probability that a receiver misses a packet
+    uint32_t latency_us; // fixed delay from transmitter to receiver
+    uint32_t jitter_us; // extra random delay, up to this much
+    bool collisions; // whether overlapping packets corrupt each other
+    // Simulated time runs this many times slower than real time, so that the time
+    // the host takes to schedule the nodes is small compared with packet air times.
+    uint32_t time_scale;
+} radiosim_config_t;
+
+// Set up a medium of the given number of nodes that all hear each other at -50dBm,
+// with no loss or latency.  The RADIOSIM_LOSS, RADIOSIM_LATENCY_US,
+// RADIOSIM_JITTER_US, RADIOSIM_COLLISIONS and RADIOSIM_TIME_SCALE environment
+// variables override the defaults.
+void radiosim_config_init(radiosim_config_t *config, int num_nodes);
+
+// Make a and b hear each other at the given RSSI, or not at all if it's 0.
+void radiosim_config_link(radiosim_config_t *config, int a, int b, int8_t rssi);
+
+// Run node(index) in a process per node, each with its own instance of the driver,
+// and return 0 if they all return 0.  The nodes start together once every one of
+// them is attached to the medium.
+int radiosim_run(const radiosim_config_t *config, int (*node)(int index));
+
+// For use by the nodes.
+int radiosim_node_index(void);
+void radiosim_barrier(void); // wait for all the nodes to get here
+void radiosim_sleep_us(uint32_t us); // sleep in simulated time, handling pending events
+uint32_t radiosim_now_us(void);
+
+// Fill in the driver configuration that radio.config() starts from.
+void radiosim_radio_config_default(microbit_radio_config_t *config);
+
+// Make the next mp_handle_pending(true) raise the given object, like a
+// KeyboardInterrupt.  nlr_jump() delivers it to the innermost nlr_push().
+void radiosim_set_pending_exception(void *exc);
+
+#endif // MICROPY_INCLUDED_RADIOSIM_RADIOSIM_H